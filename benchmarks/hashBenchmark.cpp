@@ -0,0 +1,138 @@
+// Measures string hash throughput and quality on real identifiers.
+//
+// Identifiers are scanned from the source files under the given paths, or
+// from the compiler's own sources by default, so lengths and shared
+// prefixes follow real code rather than random bytes. Each hash is timed
+// over the whole set and checked for 32-bit collisions, which cost the
+// interner's tables a string comparison, and for balance across the
+// interner's 64 shards, which are picked by the top bits.
+
+#include "ml/Basic/StringHash.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace {
+
+constexpr size_t kRounds = 200;
+constexpr unsigned kShardBits = 6;
+
+// Keeps the timed loops from being optimized away
+volatile uint64_t gSink = 0;
+
+bool isIdentifierStart(char c) {
+  return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+}
+
+bool isIdentifierChar(char c) {
+  return isIdentifierStart(c) || (c >= '0' && c <= '9');
+}
+
+// Every identifier occurrence, in file order, as a lexer would see them
+std::vector<std::string>
+scanIdentifiers(const std::vector<std::string> &roots) {
+  std::vector<std::string> names;
+  for (const auto &root : roots) {
+    for (const auto &entry :
+         std::filesystem::recursive_directory_iterator(root)) {
+      auto ext = entry.path().extension();
+      if (!entry.is_regular_file() || (ext != ".cpp" && ext != ".hpp")) {
+        continue;
+      }
+
+      std::ifstream file(entry.path());
+      std::string text((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+      for (size_t i = 0; i < text.size();) {
+        if (!isIdentifierStart(text[i])) {
+          ++i;
+          continue;
+        }
+        size_t start = i;
+        while (i < text.size() && isIdentifierChar(text[i])) {
+          ++i;
+        }
+        names.push_back(text.substr(start, i - start));
+      }
+    }
+  }
+  return names;
+}
+
+template <typename HashFn>
+void measure(const char *name, const std::vector<std::string> &names,
+             const std::vector<std::string> &unique, HashFn hash) {
+  uint64_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t round = 0; round < kRounds; ++round) {
+    for (const auto &str : names) {
+      sink += hash(str);
+    }
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  gSink = sink;
+  double perHash =
+      elapsed.count() / static_cast<double>(kRounds * names.size());
+
+  std::unordered_set<uint32_t> low;
+  size_t shards[size_t{1} << kShardBits] = {};
+  for (const auto &str : unique) {
+    uint64_t value = hash(str);
+    low.insert(static_cast<uint32_t>(value));
+    ++shards[value >> (64 - kShardBits)];
+  }
+  double average = static_cast<double>(unique.size()) /
+                   static_cast<double>(std::size(shards));
+  double worst = static_cast<double>(*std::max_element(
+                     std::begin(shards), std::end(shards))) /
+                 average;
+
+  std::printf("%-18s %10.2f %14zu %12.2f\n", name, perHash,
+              unique.size() - low.size(), worst);
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::vector<std::string> roots(argv + 1, argv + argc);
+  if (roots.empty()) {
+    roots = {ML_SOURCE_DIR "/src", ML_SOURCE_DIR "/include"};
+  }
+
+  std::vector<std::string> names = scanIdentifiers(roots);
+  std::set<std::string> distinct(names.begin(), names.end());
+  std::vector<std::string> unique(distinct.begin(), distinct.end());
+  if (names.empty()) {
+    std::fprintf(stderr, "no identifiers found\n");
+    return 1;
+  }
+
+  size_t totalLength = 0;
+  for (const auto &str : names) {
+    totalLength += str.size();
+  }
+  std::printf("%zu identifiers, %zu distinct, %.1f bytes on average\n\n",
+              names.size(), unique.size(),
+              static_cast<double>(totalLength) /
+                  static_cast<double>(names.size()));
+
+  std::printf("%-18s %10s %14s %12s\n", "hash", "ns/hash",
+              "32-bit clashes", "worst shard");
+  measure("std::hash", names, unique, [](std::string_view str) {
+    return static_cast<uint64_t>(std::hash<std::string_view>{}(str));
+  });
+  measure("ml::StringHash", names, unique,
+          [](std::string_view str) { return ml::StringHash::hash(str); });
+  return 0;
+}
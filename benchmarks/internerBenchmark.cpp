@@ -0,0 +1,150 @@
+// Measures StringInterner throughput as lexing threads are added.
+//
+// Every thread interns the same identifier-like workload, so most calls hit
+// existing strings, as they do when lexing a codebase. A single-lock table
+// is measured alongside as the baseline the sharded interner replaces, the
+// sharded interner fed in lexer-sized batches, and a frozen interner as the
+// read-mostly phases after lexing see it.
+
+#include "ml/Basic/ConcurrentArena.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+constexpr size_t kUniqueNames = 20000;
+constexpr size_t kInternsPerThread = 1000000;
+constexpr size_t kThreadCounts[] = {1, 2, 4, 8, 16, 32};
+constexpr size_t kBatchSize = 256;
+
+// One lock around one table: what every thread contended on before sharding
+class GlobalLockInterner {
+public:
+  const char *intern(std::string_view str) {
+    std::lock_guard<std::mutex> lock(Mutex);
+    auto it = Map.find(str);
+    if (it != Map.end()) {
+      return it->second.data();
+    }
+    auto owned = std::make_unique<std::string>(str);
+    const char *ptr = owned->c_str();
+    Map.emplace(std::string_view(*owned), std::string_view(*owned));
+    Owned.push_back(std::move(owned));
+    return ptr;
+  }
+
+private:
+  std::mutex Mutex;
+  std::unordered_map<std::string_view, std::string_view> Map;
+  std::vector<std::unique_ptr<std::string>> Owned;
+};
+
+std::vector<std::string> makeNames() {
+  static const char *const kPrefixes[] = {"get", "set", "is", "make", "tmp",
+                                          "node", "value", "index"};
+  std::vector<std::string> names;
+  names.reserve(kUniqueNames);
+  for (size_t i = 0; i < kUniqueNames; ++i) {
+    names.push_back(std::string(kPrefixes[i % 8]) + "_" + std::to_string(i));
+  }
+  return names;
+}
+
+template <typename InternFn>
+double run(size_t threadCount, const std::vector<std::string> &names,
+           InternFn intern) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&, t] {
+      // A cheap LCG gives each thread its own access order
+      size_t state = t * 2654435761u + 1;
+      for (size_t i = 0; i < kInternsPerThread; ++i) {
+        state = state * 6364136223846793005u + 1442695040888963407u;
+        intern(names[(state >> 33) % names.size()]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  // Million interns per second, across all threads
+  return static_cast<double>(threadCount * kInternsPerThread) /
+         elapsed.count() / 1e6;
+}
+
+// As run(), but hands the interner kBatchSize strings at a time
+double runBatched(size_t threadCount, const std::vector<std::string> &names,
+                  ml::StringInterner &interner) {
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t t = 0; t < threadCount; ++t) {
+    threads.emplace_back([&, t] {
+      std::vector<std::string_view> batch(kBatchSize);
+      std::vector<ml::InternedString> out(kBatchSize);
+      size_t state = t * 2654435761u + 1;
+      for (size_t i = 0; i < kInternsPerThread; i += kBatchSize) {
+        for (auto &str : batch) {
+          state = state * 6364136223846793005u + 1442695040888963407u;
+          str = names[(state >> 33) % names.size()];
+        }
+        interner.internBatch(batch, out);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  size_t perThread = (kInternsPerThread + kBatchSize - 1) / kBatchSize *
+                     kBatchSize;
+  return static_cast<double>(threadCount * perThread) / elapsed.count() /
+         1e6;
+}
+
+} // namespace
+
+int main() {
+  std::vector<std::string> names = makeNames();
+
+  std::printf("%8s %16s %16s %16s %16s\n", "threads", "global (Mops/s)",
+              "sharded (Mops/s)", "batched (Mops/s)", "frozen (Mops/s)");
+  for (size_t threadCount : kThreadCounts) {
+    GlobalLockInterner global;
+    double globalRate = run(threadCount, names, [&](const std::string &str) {
+      return global.intern(str);
+    });
+
+    ml::ArenaAllocator parent;
+    ml::ConcurrentArena arena(parent);
+    ml::StringInterner sharded(arena);
+    double shardedRate = run(threadCount, names, [&](const std::string &str) {
+      return sharded.intern(str);
+    });
+
+    ml::ArenaAllocator batchParent;
+    ml::ConcurrentArena batchArena(batchParent);
+    ml::StringInterner batched(batchArena);
+    double batchedRate = runBatched(threadCount, names, batched);
+
+    sharded.freeze();
+    double frozenRate = run(threadCount, names, [&](const std::string &str) {
+      return sharded.intern(str);
+    });
+
+    std::printf("%8zu %16.2f %16.2f %16.2f %16.2f\n", threadCount,
+                globalRate, shardedRate, batchedRate, frozenRate);
+  }
+  return 0;
+}
@@ -1,5 +1,11 @@
 #pragma once
 
+#include "ml/Basic/ArenaProfiler.hpp"
+#include "ml/Basic/ArenaStats.hpp"
+#include "ml/Basic/MemoryBudget.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -8,96 +14,43 @@
 #include <iosfwd>
 #include <list>
 #include <memory>
+#include <memory_resource>
 #include <new>
+#include <string>
 #include <type_traits>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace ml {
 
 /**
- * \struct ArenaStats ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
- * \brief A container for statistics about \ref ArenaAllocator usage.
- * \details Holds various statistics about the memory usage
- * of an \ref ArenaAllocator instance, including:
- * \li Total allocated bytes,
- * \li Requested bytes,
- * \li Allocation count,
- * \li Chunk count,
- * \li Peak usage,
- * \li Current usage,
- * \li Wasted bytes due to fragmentation or alignment.
- * It also provides methods to compute fragmentation ratio and efficiency.
- * \see ArenaAllocator for usage context.
+ * \enum ArenaBackend ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
+ * \brief Selects where an \ref ArenaAllocator obtains its chunks from.
  */
-struct ArenaStats {
+enum class ArenaBackend : uint8_t {
+  /// Chunks are allocated from the heap.
+  Heap,
 
-  /**
-   * \brief The total bytes allocated from the system.
-   * \details Tracks the total number of bytes allocated by the
-   * arena allocator from the underlying system or heap.
-   */
-  size_t allocatedCount = 0;
-
-  /**
-   * \brief The total bytes requested by the user.
-   * \details Tracks the total number of bytes requested by the
-   * user through allocation calls.
-   */
-  size_t requestedCount = 0;
-
-  /**
-   * \brief The number of allocation calls made.
-   * \details Tracks how many times memory allocation was requested
-   * from the arena allocator.
-   */
-  size_t allocationCount = 0;
-
-  /**
-   * \brief The number of memory chunks.
-   * \details Tracks how many memory chunks have been allocated
-   * by the arena allocator.
-   */
-  size_t chunkCount = 0;
-
-  /**
-   * \brief The peak memory usage.
-   * \details Tracks the highest amount of memory used at any
-   * point in time.
-   */
-  size_t peakUsage = 0;
-
-  /**
-   * \brief The current memory usage.
-   */
-  size_t currentUsage = 0;
+  /// Chunks are large virtual memory reservations whose pages are
+  /// committed on demand. Falls back to \ref Heap when reservation fails.
+  VirtualMemory
+};
 
-  /**
-   * \brief The bytes lost to alignment or fragmentation.
-   * \details Tracks the number of bytes wasted due to alignment
-   * requirements or fragmentation within the arena allocator.
-   */
-  size_t wastedByteCount = 0;
+/**
+ * \struct ArenaChunkDeleter ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
+ * \brief Releases the memory owned by an \ref ArenaChunk.
+ * \details Frees heap chunks with \c delete[] and unmaps virtual memory
+ * reservations.
+ */
+struct ArenaChunkDeleter {
 
   /**
-   * \brief Gets the fragmentation ratio.
-   * \return Fragmentation ratio as a double in [0.0, 1.0]
+   * \brief The size of the virtual memory reservation, or 0 for heap memory.
    */
-  double getFragmentationRatio() const {
-    return requestedCount > 0
-               ? static_cast<double>(wastedByteCount) / requestedCount
-               : 0.0;
-  }
+  size_t reservedSize = 0;
 
-  /**
-   * \brief Gets the allocation efficiency.
-   * \return Efficiency ratio as a double in [0.0, 1.0]
-   */
-  double getEfficiency() const {
-    return allocatedCount > 0
-               ? static_cast<double>(requestedCount) / allocatedCount
-               : 0.0;
-  }
+  void operator()(char *ptr) const;
 };
 
 /**
@@ -114,10 +67,11 @@ struct ArenaChunk {
    * \brief The memory block for this chunk.
    * \details A unique pointer managing the memory allocated for this chunk.
    */
-  std::unique_ptr<char[]> memory;
+  std::unique_ptr<char[], ArenaChunkDeleter> memory;
 
   /**
-   * \brief The total size of the chunk in bytes.
+   * \brief The total usable size of the chunk in bytes.
+   * \details For virtual memory chunks this is the committed size.
    */
   size_t size;
 
@@ -126,8 +80,29 @@ struct ArenaChunk {
    */
   size_t used;
 
+  /**
+   * \brief The size of the virtual memory reservation in bytes.
+   * \details Zero for heap chunks.
+   */
+  size_t reserved;
+
+  /**
+   * \brief Constructs a heap chunk.
+   * \param size The size of the chunk in bytes
+   * \note The memory is left uninitialized.
+   */
   ArenaChunk(size_t size)
-      : memory(std::make_unique<char[]>(size)), size(size), used(0) {}
+      : memory(new char[size]), size(size), used(0), reserved(0) {}
+
+  /**
+   * \brief Constructs a chunk over a virtual memory reservation.
+   * \param reservation The start of the reserved address range
+   * \param reserved The size of the reservation in bytes
+   * \note No pages are committed initially.
+   */
+  ArenaChunk(char *reservation, size_t reserved)
+      : memory(reservation, ArenaChunkDeleter{reserved}), size(0), used(0),
+        reserved(reserved) {}
 
   ArenaChunk(const ArenaChunk &) = delete;
   ArenaChunk &operator=(const ArenaChunk &) = delete;
@@ -154,6 +129,18 @@ struct ArenaChunk {
    */
   bool canFit(size_t size) const { return getRemaining() >= size; }
 
+  /**
+   * \brief Checks if the chunk is backed by a virtual memory reservation.
+   * \return True if pages can be committed on demand
+   */
+  bool isVirtual() const { return reserved != 0; }
+
+  /**
+   * \brief Gets the most bytes this chunk can ever hold.
+   * \return The reserved size for virtual chunks, otherwise the chunk size
+   */
+  size_t getCapacity() const { return isVirtual() ? reserved : size; }
+
   /**
    * \brief Allocates memory within this chunk.
    * \param size The size of memory to allocate
@@ -180,16 +167,162 @@ struct ArenaChunk {
 };
 
 /**
- * \class ArenaAllocator ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
+ * \struct ArenaCleanup ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
+ * \brief A pending destructor call for an object living in an arena.
+ * \details Cleanups are allocated in the arena alongside their object and
+ * linked newest-first, so they run in reverse order of construction.
+ * \see ArenaAllocator::allocate() for registration.
+ */
+struct ArenaCleanup {
+
+  /**
+   * \brief Destroys the object.
+   */
+  void (*destroy)(void *object);
+
+  /**
+   * \brief The object to destroy.
+   */
+  void *object;
+
+  /**
+   * \brief The previously registered cleanup.
+   */
+  ArenaCleanup *next;
+};
+
+/**
+ * \struct ArenaMarker ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
+ * \brief A saved allocation position within an \ref ArenaAllocator.
+ * \details Records the active chunk index and its bump offset so that the
+ * arena can later be rewound to this point, releasing everything allocated
+ * after it in O(1) per released chunk.
+ * \see ArenaAllocator::getMarker() and ArenaAllocator::rewind().
+ * \see ArenaScope for the RAII wrapper.
+ */
+struct ArenaMarker {
+
+  /**
+   * \brief The index of the chunk that was active when the marker was taken.
+   */
+  size_t chunkIndex = 0;
+
+  /**
+   * \brief The number of bytes used in that chunk at the time of the marker.
+   */
+  size_t used = 0;
+
+  /**
+   * \brief The most recent pending destructor at the time of the marker.
+   */
+  ArenaCleanup *cleanups = nullptr;
+};
+
+template <typename StatsPolicy> class BasicArenaAllocator;
+
+/**
+ * \brief The arena used throughout the compiler.
+ * \details Counts allocations so that statistics can be reported, or
+ * profiles them by subsystem when built with \c ML_ARENA_PROFILING. Use
+ * \ref BasicArenaAllocator directly to select another stats policy.
+ */
+#ifdef ML_ARENA_PROFILING
+using ArenaAllocator = BasicArenaAllocator<ArenaProfilingStats>;
+#else
+using ArenaAllocator = BasicArenaAllocator<ArenaCountingStats>;
+#endif
+
+/**
+ * \class BasicArenaMemoryResource
+ * \brief A \c std::pmr::memory_resource backed by an arena.
+ * \tparam Arena The arena type
+ * \details Lets standard pmr containers draw from an arena without changing
+ * their type. Deallocation is a no-op; the memory is reclaimed when the
+ * arena is reset, rewound or destroyed. Requests larger than
+ * \ref BasicArenaAllocator::kMaxAllocationSize are forwarded to an upstream
+ * resource and returned to it on deallocation.
+ * \see BasicArenaAllocator::getMemoryResource() for the arena's own
+ * instance.
+ */
+template <typename Arena>
+class BasicArenaMemoryResource : public std::pmr::memory_resource {
+public:
+  /**
+   * \brief Constructs a memory resource drawing from \p arena.
+   * \param arena The arena that owns small allocations
+   * \param upstream The resource serving oversized allocations
+   */
+  explicit BasicArenaMemoryResource(
+      Arena &arena,
+      std::pmr::memory_resource *upstream = std::pmr::get_default_resource())
+      : arena(&arena), upstream(upstream) {}
+
+  /**
+   * \brief Gets the arena allocations are drawn from.
+   * \return The backing arena
+   */
+  Arena &getArena() const { return *arena; }
+
+  /**
+   * \brief Gets the resource serving oversized allocations.
+   * \return The upstream memory resource
+   */
+  std::pmr::memory_resource *getUpstream() const { return upstream; }
+
+private:
+  void *do_allocate(size_t bytes, size_t alignment) override {
+    if (bytes > Arena::kMaxAllocationSize) {
+      return upstream->allocate(bytes, alignment);
+    }
+
+    // pmr requires a unique non-null pointer even for empty requests
+    void *ptr = arena->allocate(bytes > 0 ? bytes : 1, alignment);
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+    return ptr;
+  }
+
+  void do_deallocate(void *ptr, size_t bytes, size_t alignment) override {
+    // Arena memory is released in bulk by the arena itself
+    if (bytes > Arena::kMaxAllocationSize) {
+      upstream->deallocate(ptr, bytes, alignment);
+    }
+  }
+
+  bool
+  do_is_equal(const std::pmr::memory_resource &other) const noexcept override {
+    auto *resource = dynamic_cast<const BasicArenaMemoryResource *>(&other);
+    return resource && resource->arena == arena &&
+           resource->upstream == upstream;
+  }
+
+  Arena *arena;
+  std::pmr::memory_resource *upstream;
+};
+
+/**
+ * \brief Memory resource drawing from an \ref ArenaAllocator.
+ */
+using ArenaMemoryResource = BasicArenaMemoryResource<ArenaAllocator>;
+
+/**
+ * \class BasicArenaAllocator ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
  * \brief An allocator using arena allocation strategy.
+ * \tparam StatsPolicy Records allocation statistics; one of
+ * \ref ArenaNoStats, \ref ArenaCountingStats or \ref ArenaTracingStats.
  * \details Manages memory in large chunks to provide fast allocation and
  * deallocation of small to medium-sized objects, minimizing fragmentation and
  * overhead. It is particularly well-suited for compiler use cases where many
  * temporary objects are created.
+ *
+ * The bump-pointer fast path is inline; with \ref ArenaNoStats it reduces
+ * to an alignment, a compare and an add.
+ * \see ArenaAllocator for the default instantiation.
  * \see ArenaStats for tracking allocation statistics.
  * \see ArenaChunk for individual memory chunk management.
  */
-class ArenaAllocator {
+template <typename StatsPolicy> class BasicArenaAllocator {
 public:
   /**
    * \brief The default chunk size for allocations. (1MB)
@@ -206,38 +339,64 @@ public:
    */
   static constexpr size_t kMaxAllocationSize = 512 * 1024;
 
+  /**
+   * \brief The largest heap chunk allocated for the preferred chunk size.
+   * (100MB)
+   */
+  static constexpr size_t kMaxChunkSize = 100 * 1024 * 1024;
+
+  /**
+   * \brief The default virtual memory reservation per chunk.
+   * \details 4GB on 64-bit targets, 256MB otherwise. Only address space is
+   * reserved; pages are committed as the arena grows.
+   */
+  static constexpr size_t kDefaultReserveSize =
+      sizeof(void *) >= 8 ? size_t{1} << 32 : size_t{1} << 28;
+
+  /**
+   * \brief The granularity at which reserved pages are committed. (2MB)
+   * \details Matches the common huge page size so that committed regions
+   * can be backed by transparent huge pages.
+   */
+  static constexpr size_t kCommitGranularity = 2 * 1024 * 1024;
+
   /**
    * \brief Constructs an ArenaAllocator with optional chunk size.
    * \param chunkSize The preferred chunk size for allocations
+   * \param backend Where chunks are obtained from
+   * \note With \ref ArenaBackend::VirtualMemory, \p chunkSize is the
+   * minimum reservation size and at least \ref kDefaultReserveSize is
+   * reserved per chunk.
    */
-  explicit ArenaAllocator(size_t chunkSize = kDefaultChunkSize);
+  explicit BasicArenaAllocator(size_t chunkSize = kDefaultChunkSize,
+                               ArenaBackend backend = ArenaBackend::Heap);
 
-  ~ArenaAllocator();
+  ~BasicArenaAllocator();
 
   /**
-   * \brief Non-copyable ArenaAllocator.
-   * \details Copying an ArenaAllocator is disallowed to prevent
+   * \brief Non-copyable BasicArenaAllocator.
+   * \details Copying an arena is disallowed to prevent
    * accidental duplication of memory management state.
    */
-  ArenaAllocator(const ArenaAllocator &) = delete;
+  BasicArenaAllocator(const BasicArenaAllocator &) = delete;
 
   /**
    * \brief Non-copyable assignment operator.
-   * \see ArenaAllocator(const ArenaAllocator &)
+   * \see BasicArenaAllocator(const BasicArenaAllocator &)
    */
-  ArenaAllocator &operator=(const ArenaAllocator &) = delete;
+  BasicArenaAllocator &operator=(const BasicArenaAllocator &) = delete;
 
   /**
-   * \brief Move constructor for ArenaAllocator.
+   * \brief Move constructor for BasicArenaAllocator.
    * \details Transfers ownership of memory chunks and state.
    */
-  ArenaAllocator(ArenaAllocator &&) noexcept;
+  BasicArenaAllocator(BasicArenaAllocator &&) noexcept;
 
   /**
-   * \brief Move assignment operator for ArenaAllocator.
+   * \brief Move assignment operator for BasicArenaAllocator.
    * \details Transfers ownership of memory chunks and state.
    */
-  ArenaAllocator &operator=(ArenaAllocator &&) noexcept;
+  BasicArenaAllocator &operator=(BasicArenaAllocator &&) noexcept;
 
   /**
    * \brief Allocates memory with default alignment.
@@ -255,7 +414,47 @@ public:
    * \return A pointer to the allocated memory or nullptr if allocation fails.
    * \warning Returns \c nullptr on failure.
    */
-  void *allocate(size_t size, size_t alignment);
+  void *allocate(size_t size, size_t alignment) {
+    // Fast path: bump within the current chunk. The unsigned wrap of
+    // size - 1 rejects both empty and oversized requests in one compare
+    if (size - 1 < kMaxAllocationSize && !Chunks.empty()) {
+      ArenaChunk &chunk = Chunks[currentChunk];
+      alignment = std::max(alignment, kDefaultAlignment);
+      uintptr_t base = reinterpret_cast<uintptr_t>(chunk.memory.get());
+      uintptr_t top = base + chunk.used;
+      uintptr_t aligned = (top + alignment - 1) & ~(alignment - 1);
+      if (aligned + size <= base + chunk.size) {
+        statsPolicy.onAllocate(size, aligned + size - top);
+        chunk.used = aligned + size - base;
+        return reinterpret_cast<void *>(aligned);
+      }
+    }
+
+    return allocateSlow(size, alignment);
+  }
+
+  /**
+   * \brief Grows or shrinks the most recent allocation in place.
+   * \param ptr The allocation to resize
+   * \param oldSize The current size of the allocation
+   * \param newSize The requested size
+   * \return True if \p ptr now spans \p newSize bytes.
+   * \details Only possible while \p ptr ends at the current chunk's bump
+   * pointer and, when growing, the chunk has room. On failure the
+   * allocation is left unchanged.
+   */
+  bool resize(void *ptr, size_t oldSize, size_t newSize);
+
+  /**
+   * \brief Releases an allocation.
+   * \param ptr The allocation to release
+   * \param size The size of the allocation
+   * \details Memory is only reclaimed if \p ptr is the most recent
+   * allocation; otherwise this is a no-op and the memory is reclaimed on
+   * \ref reset().
+   * \warning Objects with pending destructors are never reclaimed.
+   */
+  void deallocate(void *ptr, size_t size) { resize(ptr, size, 0); }
 
   /**
    * \brief Allocates and constructs an object of type T.
@@ -265,17 +464,34 @@ public:
    * \return A pointer to the constructed object.
    * \throws std::bad_alloc if allocation fails.
    * \warning Object size must not exceed \ref kMaxAllocationSize.
+   * \note Non-trivially destructible objects are destroyed when the arena is
+   * reset, cleared, rewound past them, or destroyed. Trivially destructible
+   * types carry no registration overhead.
    */
   template <typename T, typename... Args> T *allocate(Args &&...args) {
     static_assert(sizeof(T) <= kMaxAllocationSize,
                   "Object too large for arena allocation");
 
-    void *ptr = allocate(sizeof(T), alignof(T));
-    if (!ptr) {
-      throw std::bad_alloc();
+    if constexpr (std::is_trivially_destructible_v<T>) {
+      void *ptr = allocate(sizeof(T), alignof(T));
+      if (!ptr) {
+        throw std::bad_alloc();
+      }
+
+      return new (ptr) T(std::forward<Args>(args)...);
+    } else {
+      // Allocate the cleanup first so a failure leaves nothing constructed
+      void *cleanupPtr = allocate(sizeof(ArenaCleanup), alignof(ArenaCleanup));
+      void *ptr = cleanupPtr ? allocate(sizeof(T), alignof(T)) : nullptr;
+      if (!ptr) {
+        throw std::bad_alloc();
+      }
+
+      T *object = new (ptr) T(std::forward<Args>(args)...);
+      cleanups = new (cleanupPtr) ArenaCleanup{
+          [](void *obj) { static_cast<T *>(obj)->~T(); }, object, cleanups};
+      return object;
     }
-
-    return new (ptr) T(std::forward<Args>(args)...);
   }
 
   /**
@@ -326,19 +542,48 @@ public:
   }
 
   /**
-   * \brief Resets the arena, freeing all allocated memory.
-   * \details This invalidates all previously allocated memory.
-   * \note Allocates a new initial chunk after reset.
+   * \brief Resets the arena and all of its statistics.
+   * \details This invalidates all previously allocated memory. Chunks are
+   * kept for reuse up to \ref getMaxRetainedBytes(); any chunks beyond that
+   * limit are returned to the system.
+   * \note The arena always keeps at least one chunk after reset.
    */
   void reset();
 
   /**
    * \brief Clears the arena, resetting all chunks.
    * \details This does not free memory but makes it available for reuse.
-   * \see reset() for full deallocation.
+   * Usage statistics are reset, while peak usage and chunk statistics are
+   * kept.
+   * \see reset() for releasing memory above the retention limit.
    */
   void clear();
 
+  /**
+   * \brief Gets the current allocation position.
+   * \return A marker that can be passed to \ref rewind().
+   * \see ArenaScope for scoped usage.
+   */
+  ArenaMarker getMarker() const {
+    if (Chunks.empty()) {
+      return ArenaMarker{};
+    }
+    return ArenaMarker{currentChunk, Chunks[currentChunk].used, cleanups};
+  }
+
+  /**
+   * \brief Rewinds the arena to a previously saved position.
+   * \param marker A marker obtained from \ref getMarker() on this arena.
+   * \details Releases every allocation made after \p marker was taken,
+   * running the destructors of objects constructed since then. Chunks that
+   * become unused are kept and reused by later allocations instead of being
+   * returned to the system. Allocations older than \p marker may have been
+   * freed or shrunk in the meantime.
+   * \warning Invalidates all memory allocated after \p marker. Markers taken
+   * after \p marker become invalid as well.
+   */
+  void rewind(const ArenaMarker &marker);
+
   /**
    * \brief Gets the current allocation statistics.
    * \return The current \ref ArenaStats.
@@ -382,79 +627,218 @@ public:
    */
   size_t getChunkSize() const { return chunkSize; }
 
+  /**
+   * \brief Gets the backend chunks are obtained from.
+   * \return The \ref ArenaBackend selected at construction
+   */
+  ArenaBackend getBackend() const { return backend; }
+
+  /**
+   * \brief Sets how many chunk bytes \ref reset() keeps for reuse.
+   * \param maxBytes The retention limit in bytes
+   * \note Defaults to \c SIZE_MAX (retain everything).
+   */
+  void setMaxRetainedBytes(size_t maxBytes) { maxRetainedBytes = maxBytes; }
+
+  /**
+   * \brief Gets how many chunk bytes \ref reset() keeps for reuse.
+   * \return The retention limit in bytes
+   */
+  size_t getMaxRetainedBytes() const { return maxRetainedBytes; }
+
+  /**
+   * \brief Gets a \c std::pmr::memory_resource drawing from this arena.
+   * \return The arena's \ref ArenaMemoryResource
+   * \details Use with the \c ArenaPmr aliases to keep arena-backed
+   * containers type-compatible with other pmr containers.
+   */
+  std::pmr::memory_resource *getMemoryResource() { return &memoryResource; }
+
+  /**
+   * \brief Charges the arena's chunks to a memory budget.
+   * \param budget The budget, or \c nullptr to detach
+   * \param name The client name shown in budget reports
+   * \details Committed chunk bytes are charged as chunks are added and
+   * released as \ref reset() frees them; individual allocations cost
+   * nothing extra.
+   */
+  void setMemoryBudget(MemoryBudget *budget, std::string name = "arena");
+
+  /**
+   * \brief Gets the stats policy instance.
+   * \return The policy, for data beyond \ref ArenaStats such as traces
+   */
+  const StatsPolicy &getStatsPolicy() const { return statsPolicy; }
+
 private:
   /**
    * \brief The list of memory chunks managed by the arena.
+   * \details Chunks up to and including \ref currentChunk are active; any
+   * chunks after it were released by \ref rewind() and are kept for reuse.
    */
   std::vector<ArenaChunk> Chunks;
 
+  /**
+   * \brief The index of the chunk currently being allocated from.
+   */
+  size_t currentChunk = 0;
+
+  /**
+   * \brief The most recently registered pending destructor.
+   */
+  ArenaCleanup *cleanups = nullptr;
+
   /**
    * \brief The preferred chunk size for allocations.
    */
   size_t chunkSize;
 
   /**
-   * \brief Statistics about arena usage.
+   * \brief The chunk bytes kept across \ref reset().
+   */
+  size_t maxRetainedBytes = SIZE_MAX;
+
+  /**
+   * \brief Where new chunks are obtained from.
+   */
+  ArenaBackend backend;
+
+  /**
+   * \brief Records allocation statistics.
    */
-  mutable ArenaStats stats;
+  [[no_unique_address]] StatsPolicy statsPolicy;
 
   /**
-   * \brief Allocates a new memory chunk.
+   * \brief The memory resource returned by \ref getMemoryResource().
+   */
+  BasicArenaMemoryResource<BasicArenaAllocator> memoryResource{*this};
+
+  /**
+   * \brief The budget chunk memory is charged to, if any.
+   */
+  MemoryBudget *budget = nullptr;
+  MemoryBudget::Client *budgetClient = nullptr;
+
+  /**
+   * \brief The chunk bytes currently charged to \ref budget.
+   */
+  size_t budgetedBytes = 0;
+
+  /**
+   * \brief Gets the number of chunks currently holding live allocations.
+   * \return The number of active chunks
+   */
+  size_t getActiveChunkCount() const {
+    return Chunks.empty() ? 0 : currentChunk + 1;
+  }
+
+  /**
+   * \brief Allocates when the fast path in \ref allocate() cannot.
+   * \param size The size of memory to allocate
+   * \param alignment The required alignment
+   * \return A pointer to the allocated memory or nullptr if allocation fails.
+   */
+  void *allocateSlow(size_t size, size_t alignment);
+
+  /**
+   * \brief Tries to allocate from the current chunk.
+   * \param size The size of memory to allocate
+   * \param alignment The required alignment
+   * \return A pointer to the allocated memory or nullptr if it does not fit.
+   */
+  void *allocateFromCurrentChunk(size_t size, size_t alignment);
+
+  /**
+   * \brief Commits more pages of the current virtual memory chunk.
+   * \param minSize The number of free bytes required after the bump pointer
+   * \return True if the current chunk now has at least \p minSize bytes free
+   */
+  bool commitCurrentChunk(size_t minSize);
+
+  /**
+   * \brief Moves allocation to the next chunk.
+   * \param minSize The minimum size required for the chunk
+   * \details Reuses a retained chunk if it is large enough, otherwise
+   * allocates a new one.
+   */
+  void advanceChunk(size_t minSize);
+
+  /**
+   * \brief Allocates a new memory chunk and makes it the current chunk.
    * \param minSize The minimum size required for the chunk
    */
   void allocateNewChunk(size_t minSize = 0);
 
   /**
-   * \brief Updates allocation statistics.
-   * \param requested The number of bytes requested
-   * \param allocated The number of bytes actually allocated
+   * \brief Runs pending destructors, newest first.
+   * \param until The cleanup to stop at (exclusive), or nullptr for all
+   */
+  void runCleanups(ArenaCleanup *until = nullptr);
+
+  /**
+   * \brief Brings the budget charge in line with the chunk bytes held.
    */
-  void updateStats(size_t requested, size_t allocated) const;
+  void syncBudget();
 };
 
+extern template class BasicArenaAllocator<ArenaNoStats>;
+extern template class BasicArenaAllocator<ArenaCountingStats>;
+extern template class BasicArenaAllocator<ArenaTracingStats>;
+extern template class BasicArenaAllocator<ArenaProfilingStats>;
+
 /**
  * \class ArenaScope ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
  * \brief A scope guard for arena allocation.
- * \details Saves the state of an \ref ArenaAllocator upon construction
- * and can restore it upon destruction. This is useful for managing
- * temporary allocations within a specific scope.
- * \see ArenaAllocator for context.
- * \note Currently not in use.
- * \todo Implement restoration of arena state on destruction.
+ * \details Saves the position of an \ref ArenaAllocator upon construction
+ * and rewinds the arena to it upon destruction. This is useful for
+ * releasing temporary allocations made within a specific scope while
+ * keeping the underlying chunks around for reuse.
+ * \see ArenaAllocator::rewind() for details.
+ * \warning Memory allocated from the arena inside the scope must not be used
+ * after the scope ends.
  */
-class ArenaScope {
+template <typename Arena = ArenaAllocator> class ArenaScope {
 public:
-  explicit ArenaScope(ArenaAllocator &arena) : arena(arena) {
-    savedStats = arena.getStats();
-  }
+  explicit ArenaScope(Arena &arena)
+      : arena(arena), marker(arena.getMarker()) {}
 
-  ~ArenaScope() {
-    // TODO: Optionally reset arena to saved state
-  }
+  ~ArenaScope() { arena.rewind(marker); }
+
+  ArenaScope(const ArenaScope &) = delete;
+  ArenaScope &operator=(const ArenaScope &) = delete;
+
+  /**
+   * \brief Gets the marker saved at the start of the scope.
+   * \return The saved \ref ArenaMarker.
+   */
+  const ArenaMarker &getMarker() const { return marker; }
 
 private:
   /**
    * \brief The arena allocator being scoped.
    */
-  ArenaAllocator &arena;
+  Arena &arena;
 
   /**
-   * \brief The saved statistics at the start of the scope.
+   * \brief The arena position at the start of the scope.
    */
-  ArenaStats savedStats;
+  ArenaMarker marker;
 };
 
 /**
  * \class ArenaSTLAllocator ArenaAllocator.hpp "ml/Basic/ArenaAllocator.hpp"
  * \brief STL-compatible allocator using \ref ArenaAllocator.
  * \tparam T The type of objects to allocate.
+ * \tparam Arena The arena type providing \c allocate(size, alignment).
  * \details This class provides an STL-compatible allocator that uses
  * \ref ArenaAllocator for memory management. It can be used with standard
  * containers like \c std::vector, \c std::list, and \c std::deque to
  * allocate memory from an arena, improving performance and memory locality.
  * \see ArenaAllocator for the underlying allocation strategy.
+ * \see ConcurrentArena for a thread-safe arena usable as \p Arena.
  */
-template <typename T> class ArenaSTLAllocator {
+template <typename T, typename Arena = ArenaAllocator>
+class ArenaSTLAllocator {
 public:
   using value_type = T;
   using pointer = T *;
@@ -469,13 +853,14 @@ public:
    * \tparam U The new type to bind to.
    */
   template <typename U> struct rebind {
-    using other = ArenaSTLAllocator<U>;
+    using other = ArenaSTLAllocator<U, Arena>;
   };
 
-  explicit ArenaSTLAllocator(ArenaAllocator &arena) : arena(&arena) {}
+  explicit ArenaSTLAllocator(Arena &arena) : arena(&arena) {}
 
   template <typename U>
-  ArenaSTLAllocator(const ArenaSTLAllocator<U> &other) : arena(other.arena) {}
+  ArenaSTLAllocator(const ArenaSTLAllocator<U, Arena> &other)
+      : arena(other.arena) {}
 
   /**
    * \brief Allocates memory for n objects of type T.
@@ -502,27 +887,26 @@ public:
    * \brief Deallocates memory for n objects of type T.
    * \param ptr Pointer to the memory to deallocate.
    * \param n The number of objects to deallocate.
-   * \note No-op since arena allocator does not support individual deallocation.
+   * \note Only reclaims the memory if it is the arena's most recent
+   * allocation, as when a container frees a buffer it just allocated.
    */
   void deallocate(T *ptr, size_type n) {
-    // Arena allocator doesn't support individual deallocation
-    (void)ptr;
-    (void)n;
+    arena->deallocate(ptr, n * sizeof(T));
   }
 
   template <typename U>
-  bool operator==(const ArenaSTLAllocator<U> &other) const {
+  bool operator==(const ArenaSTLAllocator<U, Arena> &other) const {
     return arena == other.arena;
   }
 
   template <typename U>
-  bool operator!=(const ArenaSTLAllocator<U> &other) const {
+  bool operator!=(const ArenaSTLAllocator<U, Arena> &other) const {
     return !(*this == other);
   }
 
 private:
-  template <typename U> friend class ArenaSTLAllocator;
-  ArenaAllocator *arena;
+  template <typename U, typename OtherArena> friend class ArenaSTLAllocator;
+  Arena *arena;
 };
 
 /// Convenience aliases for STL containers with arena allocation
@@ -545,4 +929,29 @@ template <typename T> using ArenaDeque = std::deque<T, ArenaSTLAllocator<T>>;
  */
 template <typename T> using ArenaList = std::list<T, ArenaSTLAllocator<T>>;
 
-} // namespace ml
\ No newline at end of file
+/// Aliases for pmr containers constructed with
+/// \ref ArenaAllocator::getMemoryResource()
+
+/**
+ * \brief pmr vector for use with an arena memory resource.
+ * \tparam T The type of objects in the vector.
+ */
+template <typename T> using ArenaPmrVector = std::pmr::vector<T>;
+
+/**
+ * \brief pmr string for use with an arena memory resource.
+ */
+using ArenaPmrString = std::pmr::string;
+
+/**
+ * \brief pmr unordered map for use with an arena memory resource.
+ * \tparam Key The key type.
+ * \tparam T The mapped type.
+ * \tparam Hash The hash function type.
+ * \tparam KeyEqual The key equality type.
+ */
+template <typename Key, typename T, typename Hash = std::hash<Key>,
+          typename KeyEqual = std::equal_to<Key>>
+using ArenaPmrUnorderedMap = std::pmr::unordered_map<Key, T, Hash, KeyEqual>;
+
+} // namespace ml
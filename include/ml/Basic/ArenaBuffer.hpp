@@ -0,0 +1,229 @@
+#pragma once
+
+#include "ml/Basic/ArenaAllocator.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace ml {
+
+/**
+ * \class ArenaBuffer ArenaBuffer.hpp "ml/Basic/ArenaBuffer.hpp"
+ * \brief A growable array whose storage lives in an \ref ArenaAllocator.
+ * \tparam T The element type; must be trivially copyable.
+ * \tparam Arena The arena type
+ * \details While the buffer is the arena's most recent allocation it grows
+ * in place with \ref ArenaAllocator::resize(), so building a large array
+ * does not leave a trail of abandoned copies behind in the arena. When
+ * something else has been allocated since, it falls back to copying into a
+ * new allocation like \ref ArenaVector.
+ * \note Fill one buffer at a time to get the most in-place growth.
+ */
+template <typename T, typename Arena = ArenaAllocator> class ArenaBuffer {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "ArenaBuffer elements are moved with memcpy");
+  static_assert(std::is_trivially_destructible_v<T>,
+                "Arena buffers only support trivially destructible types");
+
+public:
+  using value_type = T;
+  using iterator = T *;
+  using const_iterator = const T *;
+
+  /**
+   * \brief Constructs an empty buffer drawing from \p arena.
+   * \param arena The arena that owns the storage
+   */
+  explicit ArenaBuffer(Arena &arena) : arena(&arena) {}
+
+  /**
+   * \brief Non-copyable ArenaBuffer.
+   */
+  ArenaBuffer(const ArenaBuffer &) = delete;
+
+  /**
+   * \brief Non-copyable assignment operator.
+   */
+  ArenaBuffer &operator=(const ArenaBuffer &) = delete;
+
+  ArenaBuffer(ArenaBuffer &&other) noexcept
+      : arena(other.arena), Data(other.Data), count(other.count),
+        bufferCapacity(other.bufferCapacity) {
+    other.Data = nullptr;
+    other.count = 0;
+    other.bufferCapacity = 0;
+  }
+
+  ArenaBuffer &operator=(ArenaBuffer &&other) noexcept {
+    if (this != &other) {
+      arena = other.arena;
+      Data = other.Data;
+      count = other.count;
+      bufferCapacity = other.bufferCapacity;
+      other.Data = nullptr;
+      other.count = 0;
+      other.bufferCapacity = 0;
+    }
+    return *this;
+  }
+
+  /**
+   * \brief Appends an element.
+   * \param value The element to append
+   * \throws std::bad_alloc if the buffer cannot grow.
+   */
+  void append(const T &value) {
+    if (count == bufferCapacity) {
+      grow(count + 1);
+    }
+    Data[count++] = value;
+  }
+
+  /**
+   * \brief Appends a range of elements.
+   * \param values The elements to append
+   * \param length The number of elements
+   * \throws std::bad_alloc if the buffer cannot grow.
+   */
+  void append(const T *values, size_t length) {
+    if (length == 0) {
+      return;
+    }
+    if (count + length > bufferCapacity) {
+      grow(count + length);
+    }
+    std::memcpy(Data + count, values, length * sizeof(T));
+    count += length;
+  }
+
+  /**
+   * \brief Ensures room for at least \p capacity elements.
+   * \param capacity The minimum capacity
+   * \throws std::bad_alloc if the buffer cannot grow.
+   */
+  void reserve(size_t capacity) {
+    if (capacity > bufferCapacity) {
+      reallocate(capacity);
+    }
+  }
+
+  /**
+   * \brief Changes the number of elements.
+   * \param size The new size
+   * \details New elements are value-initialized.
+   * \throws std::bad_alloc if the buffer cannot grow.
+   */
+  void resize(size_t size) {
+    if (size > bufferCapacity) {
+      grow(size);
+    }
+    for (size_t i = count; i < size; ++i) {
+      new (Data + i) T();
+    }
+    count = size;
+  }
+
+  /**
+   * \brief Returns unused capacity to the arena if possible.
+   * \details Succeeds while the buffer is the arena's most recent
+   * allocation; otherwise the capacity is kept.
+   */
+  void shrinkToFit() {
+    if (Data && arena->resize(Data, bufferCapacity * sizeof(T),
+                              std::max<size_t>(count, 1) * sizeof(T))) {
+      bufferCapacity = std::max<size_t>(count, 1);
+    }
+  }
+
+  /**
+   * \brief Removes all elements, keeping the capacity.
+   */
+  void clear() { count = 0; }
+
+  size_t size() const { return count; }
+  size_t capacity() const { return bufferCapacity; }
+  bool empty() const { return count == 0; }
+
+  T *data() { return Data; }
+  const T *data() const { return Data; }
+
+  T &operator[](size_t index) {
+    assert(index < count && "ArenaBuffer index out of range");
+    return Data[index];
+  }
+
+  const T &operator[](size_t index) const {
+    assert(index < count && "ArenaBuffer index out of range");
+    return Data[index];
+  }
+
+  T &back() {
+    assert(count > 0 && "ArenaBuffer is empty");
+    return Data[count - 1];
+  }
+
+  iterator begin() { return Data; }
+  iterator end() { return Data + count; }
+  const_iterator begin() const { return Data; }
+  const_iterator end() const { return Data + count; }
+
+  /**
+   * \brief Gets the arena that owns the storage.
+   * \return The backing arena
+   */
+  Arena &getArena() const { return *arena; }
+
+private:
+  /**
+   * \brief The smallest capacity allocated.
+   */
+  static constexpr size_t kMinCapacity =
+      std::max<size_t>(1, 64 / sizeof(T));
+
+  /**
+   * \brief Grows geometrically to hold at least \p minCapacity elements.
+   * \param minCapacity The required capacity
+   */
+  void grow(size_t minCapacity) {
+    reallocate(std::max({minCapacity, bufferCapacity * 2, kMinCapacity}));
+  }
+
+  /**
+   * \brief Moves the storage to a block of \p capacity elements.
+   * \param capacity The new capacity
+   * \throws std::bad_alloc if the allocation fails.
+   */
+  void reallocate(size_t capacity) {
+    if (capacity > Arena::kMaxAllocationSize / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+
+    // Extend in place while nothing has been allocated after the buffer
+    if (Data && arena->resize(Data, bufferCapacity * sizeof(T),
+                              capacity * sizeof(T))) {
+      bufferCapacity = capacity;
+      return;
+    }
+
+    void *ptr = arena->allocate(capacity * sizeof(T), alignof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+
+    if (count > 0) {
+      std::memcpy(ptr, Data, count * sizeof(T));
+    }
+    Data = static_cast<T *>(ptr);
+    bufferCapacity = capacity;
+  }
+
+  Arena *arena;
+  T *Data = nullptr;
+  size_t count = 0;
+  size_t bufferCapacity = 0;
+};
+
+} // namespace ml
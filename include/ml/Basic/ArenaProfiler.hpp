@@ -0,0 +1,194 @@
+#pragma once
+
+#include "ml/Basic/ArenaStats.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \enum ArenaCategory ArenaProfiler.hpp "ml/Basic/ArenaProfiler.hpp"
+ * \brief The subsystems arena allocations are attributed to.
+ * \see ArenaProfileScope for tagging allocations.
+ */
+enum class ArenaCategory : uint8_t {
+  /// Allocations made outside any profiling scope.
+  Untagged,
+  Interner,
+  Lexer,
+  Diagnostics,
+  FileCache,
+};
+
+/**
+ * \brief Gets the report name of a category.
+ * \param category The category
+ * \return A lowercase name such as \c "file_cache"
+ */
+const char *getArenaCategoryName(ArenaCategory category);
+
+/**
+ * \class ArenaProfileScope ArenaProfiler.hpp "ml/Basic/ArenaProfiler.hpp"
+ * \brief Attributes the calling thread's arena allocations to a category.
+ * \details Scopes nest, so an allocation made by the interner while lexing
+ * is recorded under \c lexer;interner. The active tag is per thread and
+ * shared by all arenas; only arenas using \ref ArenaProfilingStats record
+ * it.
+ * \see ML_ARENA_PROFILE_SCOPE for scopes that vanish unless profiling is
+ * enabled.
+ */
+class ArenaProfileScope {
+public:
+  /**
+   * \brief The deepest nesting recorded; deeper scopes are ignored.
+   */
+  static constexpr size_t kMaxDepth = 16;
+
+  explicit ArenaProfileScope(ArenaCategory category) : previous(currentTag) {
+    // Tags are stacks of 4-bit categories, innermost in the low bits
+    if ((currentTag >> (4 * (kMaxDepth - 1))) == 0) {
+      currentTag = (currentTag << 4) | static_cast<uint64_t>(category);
+    }
+  }
+
+  ~ArenaProfileScope() { currentTag = previous; }
+
+  ArenaProfileScope(const ArenaProfileScope &) = delete;
+  ArenaProfileScope &operator=(const ArenaProfileScope &) = delete;
+
+  /**
+   * \brief Gets the calling thread's current tag.
+   * \return The encoded category stack, or zero outside any scope
+   */
+  static uint64_t getCurrentTag() { return currentTag; }
+
+  /**
+   * \brief Formats a tag as a semicolon-separated category stack.
+   * \param tag An encoded category stack
+   * \return The stack, outermost first, e.g. \c "lexer;interner"
+   */
+  static std::string formatTag(uint64_t tag);
+
+private:
+  static inline thread_local uint64_t currentTag = 0;
+  uint64_t previous;
+};
+
+/**
+ * \struct ArenaProfileEntry ArenaProfiler.hpp "ml/Basic/ArenaProfiler.hpp"
+ * \brief Aggregated allocations for one tag.
+ * \details Byte counts include alignment padding.
+ */
+struct ArenaProfileEntry {
+  /**
+   * \brief The total bytes allocated under the tag.
+   */
+  size_t byteCount = 0;
+
+  /**
+   * \brief The number of allocations made under the tag.
+   */
+  size_t allocationCount = 0;
+
+  /**
+   * \brief The bytes currently live under the tag.
+   */
+  size_t liveByteCount = 0;
+
+  /**
+   * \brief The peak of \ref liveByteCount.
+   */
+  size_t peakByteCount = 0;
+};
+
+/**
+ * \enum ArenaProfileMetric ArenaProfiler.hpp "ml/Basic/ArenaProfiler.hpp"
+ * \brief The value reported per stack in a folded-stack dump.
+ */
+enum class ArenaProfileMetric : uint8_t { Bytes, Allocations, PeakBytes };
+
+/**
+ * \struct ArenaProfilingStats ArenaProfiler.hpp "ml/Basic/ArenaProfiler.hpp"
+ * \brief Stats policy that counts like \ref ArenaCountingStats and also
+ * attributes every allocation to the current \ref ArenaProfileScope tag.
+ * \details Since arena memory is released in LIFO order, the policy keeps a
+ * stack of tagged ranges and charges releases to the most recent ones, so
+ * live and peak bytes per tag stay exact across rewinds. Consecutive
+ * allocations with the same tag share a range.
+ * \note Allocations a \ref ConcurrentArena makes from its parent are
+ * charged to the thread that triggered the refill.
+ */
+struct ArenaProfilingStats : ArenaCountingStats {
+  void onAllocate(size_t requested, size_t allocated);
+  void onGrow(size_t bytes);
+  void onRelease(size_t bytes);
+  void onClear();
+  void onReset() { *this = ArenaProfilingStats{}; }
+
+  /**
+   * \brief Prints the per-tag table, largest first.
+   * \param OS The output stream to print to
+   */
+  void print(std::ostream &OS) const;
+
+  /**
+   * \brief Writes the profile in folded-stack format.
+   * \param OS The output stream to write to
+   * \param metric The value to report for each stack
+   * \details Each line is a stack followed by its value, e.g.
+   * \c "lexer;interner 4096", as consumed by \c flamegraph.pl and
+   * compatible viewers.
+   */
+  void writeFoldedStacks(
+      std::ostream &OS,
+      ArenaProfileMetric metric = ArenaProfileMetric::Bytes) const;
+
+  /**
+   * \brief Gets the aggregate for a tag.
+   * \param tag An encoded category stack
+   * \return The entry, or an empty entry if nothing was recorded
+   */
+  ArenaProfileEntry getEntry(uint64_t tag) const;
+
+  /**
+   * \brief The aggregates by tag.
+   */
+  std::unordered_map<uint64_t, ArenaProfileEntry> Profile;
+
+private:
+  /**
+   * \struct TaggedRange
+   * \brief A run of live bytes allocated under one tag.
+   */
+  struct TaggedRange {
+    uint64_t tag;
+    size_t byteCount;
+  };
+
+  /**
+   * \brief Charges newly live bytes to a tag.
+   * \param tag The tag to charge
+   * \param bytes The number of bytes
+   * \return The tag's entry
+   */
+  ArenaProfileEntry &charge(uint64_t tag, size_t bytes);
+
+  /**
+   * \brief Live ranges in allocation order.
+   */
+  std::vector<TaggedRange> LiveRanges;
+};
+
+} // namespace ml
+
+#ifdef ML_ARENA_PROFILING
+/// Attributes arena allocations in the enclosing scope to \p category.
+#define ML_ARENA_PROFILE_SCOPE(category)                                       \
+  ::ml::ArenaProfileScope mlArenaProfileScope(::ml::ArenaCategory::category)
+#else
+#define ML_ARENA_PROFILE_SCOPE(category) ((void)0)
+#endif
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "ml/Basic/ArenaAllocator.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+namespace ml {
+
+/**
+ * \class OffsetPtr ArenaSnapshot.hpp "ml/Basic/ArenaSnapshot.hpp"
+ * \brief A pointer stored as the distance from itself to its target.
+ * \tparam T The pointee type
+ * \details Because the offset is relative to the pointer's own address, a
+ * block of memory whose internal links are all OffsetPtrs stays valid
+ * wherever it is copied or mapped. Both the pointer and its target must
+ * live in the same block.
+ * \note Copying an OffsetPtr re-targets the copy at the same object, so a
+ * copy made outside the block still points into it.
+ */
+template <typename T> class OffsetPtr {
+public:
+  OffsetPtr() = default;
+  OffsetPtr(T *ptr) { set(ptr); }
+  OffsetPtr(const OffsetPtr &other) { set(other.get()); }
+
+  OffsetPtr &operator=(const OffsetPtr &other) {
+    set(other.get());
+    return *this;
+  }
+
+  OffsetPtr &operator=(T *ptr) {
+    set(ptr);
+    return *this;
+  }
+
+  /**
+   * \brief Gets the target.
+   * \return The target, or \c nullptr if the pointer is null
+   */
+  T *get() const {
+    if (offset == 0) {
+      return nullptr;
+    }
+    return reinterpret_cast<T *>(reinterpret_cast<intptr_t>(this) + offset);
+  }
+
+  T *operator->() const { return get(); }
+  explicit operator bool() const { return offset != 0; }
+
+  template <typename U = T>
+  std::enable_if_t<!std::is_void_v<U>, U &> operator*() const {
+    return *get();
+  }
+
+  /**
+   * \brief Gets the raw distance to the target.
+   * \return The offset in bytes, or zero if the pointer is null
+   */
+  int64_t getOffset() const { return offset; }
+
+private:
+  void set(T *ptr) {
+    offset = ptr ? reinterpret_cast<intptr_t>(ptr) -
+                       reinterpret_cast<intptr_t>(this)
+                 : 0;
+  }
+
+  int64_t offset = 0;
+};
+
+/**
+ * \struct SnapshotString ArenaSnapshot.hpp "ml/Basic/ArenaSnapshot.hpp"
+ * \brief A relocatable, null-terminated string inside a snapshot.
+ */
+struct SnapshotString {
+  OffsetPtr<const char> Data;
+  uint64_t size = 0;
+
+  std::string_view view() const {
+    return Data ? std::string_view(Data.get(), size) : std::string_view();
+  }
+};
+
+/**
+ * \struct ArenaSnapshotHeader ArenaSnapshot.hpp "ml/Basic/ArenaSnapshot.hpp"
+ * \brief The first bytes of every snapshot image.
+ */
+struct ArenaSnapshotHeader {
+  /**
+   * \brief Identifies the file as a snapshot. ("MLSN")
+   */
+  static constexpr uint32_t kMagic = 0x4E534C4D;
+
+  /**
+   * \brief The image layout version; bump when image structs or the
+   * stored string hashes change.
+   */
+  static constexpr uint32_t kVersion = 3;
+
+  uint32_t magic = kMagic;
+  uint32_t version = kVersion;
+
+  /**
+   * \brief The size of the whole image in bytes, header included.
+   */
+  uint64_t size = 0;
+
+  /**
+   * \brief The object the image was built for.
+   */
+  OffsetPtr<const void> root;
+};
+
+/**
+ * \class ArenaSnapshotWriter ArenaSnapshot.hpp "ml/Basic/ArenaSnapshot.hpp"
+ * \brief Builds a position-independent image in a single arena chunk.
+ * \details Objects are allocated from a virtual memory arena whose first
+ * chunk reserves enough address space for the whole image, so the image is
+ * one contiguous range that is written to disk with a single \c write. Link
+ * objects with \ref OffsetPtr, never raw pointers.
+ * \see ArenaSnapshot for mapping an image back in.
+ */
+class ArenaSnapshotWriter {
+public:
+  ArenaSnapshotWriter();
+
+  ArenaSnapshotWriter(const ArenaSnapshotWriter &) = delete;
+  ArenaSnapshotWriter &operator=(const ArenaSnapshotWriter &) = delete;
+
+  /**
+   * \brief Allocates and constructs an object in the image.
+   * \tparam T The type of object; must be trivially destructible
+   * \param args The constructor arguments
+   * \return A pointer to the object, valid until the writer is destroyed
+   * \throws std::bad_alloc if the image cannot grow.
+   */
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Snapshot objects are never destroyed");
+    return arena.allocate<T>(std::forward<Args>(args)...);
+  }
+
+  /**
+   * \brief Allocates raw bytes in the image.
+   * \param size The number of bytes
+   * \param alignment The required alignment
+   * \return The uninitialized bytes, valid until the writer is destroyed
+   * \throws std::bad_alloc if the image cannot grow.
+   */
+  void *allocate(size_t size, size_t alignment);
+
+  /**
+   * \brief Copies a string into the image.
+   * \param str The string to copy
+   * \return A relocatable reference to the copy
+   * \throws std::bad_alloc if the image cannot grow.
+   */
+  SnapshotString createString(std::string_view str);
+
+  /**
+   * \brief Sets the object returned by \ref ArenaSnapshot::getRoot().
+   * \param root An object created by this writer
+   */
+  void setRoot(const void *root) { header->root = root; }
+
+  /**
+   * \brief Gets the current image size.
+   * \return The size in bytes, header included
+   */
+  size_t getSize() const { return arena.getTotalUsed(); }
+
+  /**
+   * \brief Writes the image to \p path.
+   * \param path The file to write
+   * \return An error code, or a default value on success
+   * \details The image is written to a temporary file beside \p path and
+   * renamed over it, so a concurrent reader never sees a partial image.
+   */
+  std::error_code write(const std::string &path) const;
+
+private:
+  BasicArenaAllocator<ArenaNoStats> arena;
+  ArenaSnapshotHeader *header;
+};
+
+/**
+ * \class ArenaSnapshot ArenaSnapshot.hpp "ml/Basic/ArenaSnapshot.hpp"
+ * \brief A snapshot image mapped read-only from disk.
+ * \details Loading costs one \c mmap; pages are faulted in as the image is
+ * read. Pointers into the image stay valid for the snapshot's lifetime.
+ */
+class ArenaSnapshot {
+public:
+  ~ArenaSnapshot();
+
+  ArenaSnapshot(const ArenaSnapshot &) = delete;
+  ArenaSnapshot &operator=(const ArenaSnapshot &) = delete;
+
+  /**
+   * \brief Maps a snapshot written by \ref ArenaSnapshotWriter::write().
+   * \param path The file to map
+   * \return The snapshot, or an error if the file cannot be mapped or is
+   * not a valid image of the current version
+   */
+  static std::pair<std::unique_ptr<ArenaSnapshot>, std::error_code>
+  open(const std::string &path);
+
+  /**
+   * \brief Gets the root object.
+   * \tparam T The type the root was created as
+   * \return The root, or \c nullptr if none was set
+   */
+  template <typename T> const T *getRoot() const {
+    return static_cast<const T *>(getHeader().root.get());
+  }
+
+  /**
+   * \brief Checks if a pointer lies inside the image.
+   * \param ptr The pointer to check
+   * \return True if \p ptr points into the mapping
+   */
+  bool contains(const void *ptr) const {
+    auto *charPtr = static_cast<const char *>(ptr);
+    return charPtr >= data && charPtr < data + size;
+  }
+
+  const char *getData() const { return data; }
+  size_t getSize() const { return size; }
+
+private:
+  ArenaSnapshot(const char *data, size_t size) : data(data), size(size) {}
+
+  const ArenaSnapshotHeader &getHeader() const {
+    return *reinterpret_cast<const ArenaSnapshotHeader *>(data);
+  }
+
+  const char *data;
+  size_t size;
+};
+
+} // namespace ml
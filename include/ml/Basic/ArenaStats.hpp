@@ -0,0 +1,316 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \struct ArenaStats ArenaStats.hpp "ml/Basic/ArenaStats.hpp"
+ * \brief A container for statistics about \ref ArenaAllocator usage.
+ * \details Holds various statistics about the memory usage
+ * of an \ref ArenaAllocator instance, including:
+ * \li Total allocated bytes,
+ * \li Requested bytes,
+ * \li Allocation count,
+ * \li Chunk count,
+ * \li Peak usage,
+ * \li Current usage,
+ * \li Active and retained chunk bytes,
+ * \li Wasted bytes due to fragmentation or alignment.
+ * It also provides methods to compute fragmentation ratio and efficiency.
+ * \see ArenaAllocator for usage context.
+ */
+struct ArenaStats {
+
+  /**
+   * \brief The total bytes allocated from the system.
+   * \details Tracks the total number of bytes currently held by the
+   * arena allocator from the underlying system or heap, including
+   * retained chunks.
+   */
+  size_t allocatedCount = 0;
+
+  /**
+   * \brief The total bytes requested by the user.
+   * \details Tracks the total number of bytes requested by the
+   * user through allocation calls.
+   */
+  size_t requestedCount = 0;
+
+  /**
+   * \brief The number of allocation calls made.
+   * \details Tracks how many times memory allocation was requested
+   * from the arena allocator.
+   */
+  size_t allocationCount = 0;
+
+  /**
+   * \brief The number of memory chunks.
+   * \details Tracks how many memory chunks have been allocated
+   * by the arena allocator.
+   */
+  size_t chunkCount = 0;
+
+  /**
+   * \brief The peak memory usage.
+   * \details Tracks the highest amount of memory used at any
+   * point in time.
+   */
+  size_t peakUsage = 0;
+
+  /**
+   * \brief The current memory usage.
+   */
+  size_t currentUsage = 0;
+
+  /**
+   * \brief The bytes lost to alignment or fragmentation.
+   * \details Tracks the number of bytes wasted due to alignment
+   * requirements or fragmentation within the arena allocator.
+   */
+  size_t wastedByteCount = 0;
+
+  /**
+   * \brief The capacity of the chunks currently holding allocations.
+   */
+  size_t activeByteCount = 0;
+
+  /**
+   * \brief The capacity of the chunks kept for reuse.
+   * \details Counts chunks released by \ref ArenaAllocator::rewind(),
+   * \ref ArenaAllocator::clear() or \ref ArenaAllocator::reset() that are
+   * still owned by the arena.
+   */
+  size_t retainedByteCount = 0;
+
+  /**
+   * \brief The number of destructors waiting to run.
+   * \details Counts objects of non-trivially destructible types allocated
+   * through \ref ArenaAllocator::allocate() that have not been destroyed.
+   */
+  size_t pendingDestructorCount = 0;
+
+  /**
+   * \brief Gets the fragmentation ratio.
+   * \return Fragmentation ratio as a double in [0.0, 1.0]
+   */
+  double getFragmentationRatio() const {
+    return requestedCount > 0
+               ? static_cast<double>(wastedByteCount) / requestedCount
+               : 0.0;
+  }
+
+  /**
+   * \brief Gets the allocation efficiency.
+   * \return Efficiency ratio as a double in [0.0, 1.0]
+   */
+  double getEfficiency() const {
+    return allocatedCount > 0
+               ? static_cast<double>(requestedCount) / allocatedCount
+               : 0.0;
+  }
+};
+
+/**
+ * \struct ArenaNoStats ArenaStats.hpp "ml/Basic/ArenaStats.hpp"
+ * \brief Stats policy that records nothing.
+ * \details Removes all per-allocation bookkeeping from the arena. Values
+ * derived from the chunks themselves, such as current usage and chunk
+ * counts, are still reported by \ref BasicArenaAllocator::getStats().
+ */
+struct ArenaNoStats {
+  /**
+   * \brief Whether allocation counters are maintained.
+   */
+  static constexpr bool kCountsAllocations = false;
+
+  void onAllocate(size_t, size_t) {}
+  void onGrow(size_t) {}
+  void onRelease(size_t) {}
+  void onClear() {}
+  void onReset() {}
+  void fill(ArenaStats &) const {}
+  void print(std::ostream &) const {}
+};
+
+/**
+ * \struct ArenaCountingStats ArenaStats.hpp "ml/Basic/ArenaStats.hpp"
+ * \brief Stats policy that counts allocations and tracks peak usage.
+ * \details Maintains the \ref ArenaStats fields that cannot be derived from
+ * the chunks: allocation count, requested and wasted bytes, and peak usage.
+ */
+struct ArenaCountingStats {
+  /**
+   * \brief Whether allocation counters are maintained.
+   */
+  static constexpr bool kCountsAllocations = true;
+
+  /**
+   * \brief Records an allocation.
+   * \param requested The number of bytes requested
+   * \param allocated The number of bytes consumed, including padding
+   */
+  void onAllocate(size_t requested, size_t allocated) {
+    ++allocationCount;
+    requestedCount += requested;
+    wastedByteCount += allocated - requested;
+    currentUsage += allocated;
+    peakUsage = std::max(peakUsage, currentUsage);
+  }
+
+  /**
+   * \brief Records an allocation growing in place.
+   * \param bytes The number of bytes added
+   */
+  void onGrow(size_t bytes) {
+    requestedCount += bytes;
+    currentUsage += bytes;
+    peakUsage = std::max(peakUsage, currentUsage);
+  }
+
+  /**
+   * \brief Records memory being released by a rewind or shrink.
+   * \param bytes The number of bytes released
+   */
+  void onRelease(size_t bytes) { currentUsage -= bytes; }
+
+  /**
+   * \brief Records the arena being cleared; peak usage is kept.
+   */
+  void onClear() {
+    allocationCount = 0;
+    requestedCount = 0;
+    wastedByteCount = 0;
+    currentUsage = 0;
+  }
+
+  /**
+   * \brief Records the arena being reset.
+   */
+  void onReset() { *this = ArenaCountingStats{}; }
+
+  /**
+   * \brief Copies the counters into \p stats.
+   * \param stats The statistics to fill in
+   */
+  void fill(ArenaStats &stats) const {
+    stats.allocationCount = allocationCount;
+    stats.requestedCount = requestedCount;
+    stats.wastedByteCount = wastedByteCount;
+    stats.peakUsage = peakUsage;
+  }
+
+  /**
+   * \brief Prints details beyond \ref ArenaStats; none for this policy.
+   */
+  void print(std::ostream &) const {}
+
+  size_t allocationCount = 0;
+  size_t requestedCount = 0;
+  size_t wastedByteCount = 0;
+  size_t currentUsage = 0;
+  size_t peakUsage = 0;
+};
+
+/**
+ * \struct ArenaTraceEvent ArenaStats.hpp "ml/Basic/ArenaStats.hpp"
+ * \brief A single event recorded by \ref ArenaTracingStats.
+ */
+struct ArenaTraceEvent {
+  enum class Kind : uint8_t { Allocate, Grow, Release, Clear, Reset };
+
+  /**
+   * \brief What happened.
+   */
+  Kind kind;
+
+  /**
+   * \brief The number of bytes involved, or zero for clear and reset.
+   */
+  size_t size;
+};
+
+/**
+ * \struct ArenaTracingStats ArenaStats.hpp "ml/Basic/ArenaStats.hpp"
+ * \brief Stats policy that counts like \ref ArenaCountingStats and also
+ * records a size histogram and an event log.
+ * \details Intended for profiling allocation patterns. The event log keeps
+ * the first \ref kMaxEvents events since the last reset, starting with
+ * that reset.
+ */
+struct ArenaTracingStats : ArenaCountingStats {
+  /**
+   * \brief The maximum number of events kept in the log.
+   */
+  static constexpr size_t kMaxEvents = 64 * 1024;
+
+  /**
+   * \brief The number of power-of-two size buckets.
+   */
+  static constexpr size_t kBucketCount = 64;
+
+  void onAllocate(size_t requested, size_t allocated) {
+    ArenaCountingStats::onAllocate(requested, allocated);
+    ++sizeHistogram[std::bit_width(requested - 1)];
+    record(ArenaTraceEvent::Kind::Allocate, requested);
+  }
+
+  void onGrow(size_t bytes) {
+    ArenaCountingStats::onGrow(bytes);
+    record(ArenaTraceEvent::Kind::Grow, bytes);
+  }
+
+  void onRelease(size_t bytes) {
+    ArenaCountingStats::onRelease(bytes);
+    record(ArenaTraceEvent::Kind::Release, bytes);
+  }
+
+  void onClear() {
+    ArenaCountingStats::onClear();
+    record(ArenaTraceEvent::Kind::Clear, 0);
+  }
+
+  void onReset() {
+    *this = ArenaTracingStats{};
+    record(ArenaTraceEvent::Kind::Reset, 0);
+  }
+
+  /**
+   * \brief Prints the size histogram and event summary.
+   * \param OS The output stream to print to
+   */
+  void print(std::ostream &OS) const;
+
+  /**
+   * \brief Allocation counts by size; bucket \c i holds sizes in
+   * \c (2^(i-1), 2^i].
+   */
+  std::array<size_t, kBucketCount> sizeHistogram{};
+
+  /**
+   * \brief The recorded events, oldest first.
+   */
+  std::vector<ArenaTraceEvent> Events;
+
+  /**
+   * \brief The number of events not recorded because the log was full.
+   */
+  size_t droppedEventCount = 0;
+
+private:
+  void record(ArenaTraceEvent::Kind kind, size_t size) {
+    if (Events.size() < kMaxEvents) {
+      Events.push_back(ArenaTraceEvent{kind, size});
+    } else {
+      ++droppedEventCount;
+    }
+  }
+};
+
+} // namespace ml
@@ -0,0 +1,290 @@
+#pragma once
+
+#include "ml/Basic/ArenaAllocator.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \class ConcurrentArena ConcurrentArena.hpp "ml/Basic/ConcurrentArena.hpp"
+ * \brief A thread-safe arena layered on top of an \ref ArenaAllocator.
+ * \details Hands each thread its own bump region carved from blocks shared
+ * by all threads. Allocation from a thread's region needs no
+ * synchronization, and refilling a region is a single atomic add on the
+ * shared block. The parent arena is only locked when a new block is
+ * needed or for allocations too large for a region.
+ *
+ * All memory is owned by the parent \ref ArenaAllocator, so it stays valid
+ * until the parent is reset or destroyed.
+ * \see ArenaAllocator for the underlying allocation strategy.
+ * \warning The parent arena must not be used directly while the
+ * ConcurrentArena is in use, since the parent itself is not thread-safe.
+ */
+class ConcurrentArena {
+public:
+  /**
+   * \brief The size of each thread's bump region. (16KB)
+   */
+  static constexpr size_t kRegionSize = 16 * 1024;
+
+  /**
+   * \brief The size of each block taken from the parent arena. (512KB)
+   */
+  static constexpr size_t kBlockSize = ArenaAllocator::kMaxAllocationSize;
+
+  /**
+   * \brief Constructs a ConcurrentArena that draws memory from \p parent.
+   * \param parent The arena that owns all allocated memory
+   */
+  explicit ConcurrentArena(ArenaAllocator &parent);
+
+  ~ConcurrentArena() = default;
+
+  /**
+   * \brief Non-copyable ConcurrentArena.
+   * \details Threads identify their regions by arena, so the arena must
+   * stay at a fixed address.
+   */
+  ConcurrentArena(const ConcurrentArena &) = delete;
+
+  /**
+   * \brief Non-copyable assignment operator.
+   * \see ConcurrentArena(const ConcurrentArena &)
+   */
+  ConcurrentArena &operator=(const ConcurrentArena &) = delete;
+
+  /**
+   * \brief Allocates memory with default alignment.
+   * \param size The size of memory to allocate
+   * \return A pointer to the allocated memory or nullptr if allocation fails.
+   * \note Uses \ref ArenaAllocator::kDefaultAlignment.
+   */
+  void *allocate(size_t size) {
+    return allocate(size, ArenaAllocator::kDefaultAlignment);
+  }
+
+  /**
+   * \brief Allocates memory with specified alignment.
+   * \param size The size of memory to allocate
+   * \param alignment The required alignment, a power of two; smaller
+   * values are raised to \ref ArenaAllocator::kDefaultAlignment
+   * \return A pointer to the allocated memory or nullptr if allocation fails.
+   * \note Safe to call concurrently from any number of threads.
+   */
+  void *allocate(size_t size, size_t alignment);
+
+  /**
+   * \brief Releases an allocation.
+   * \param ptr The allocation to release
+   * \param size The size of the allocation
+   * \details Memory is only reclaimed if \p ptr is the calling thread's
+   * most recent allocation from its region; otherwise this is a no-op.
+   */
+  void deallocate(void *ptr, size_t size);
+
+  /**
+   * \brief Allocates and constructs an object of type T.
+   * \tparam T The type of object to allocate
+   * \tparam Args The constructor argument types
+   * \param args The constructor arguments
+   * \return A pointer to the constructed object.
+   * \throws std::bad_alloc if allocation fails.
+   * \warning Only supports trivially destructible types; destructors are
+   * never run. Use \ref ArenaAllocator::allocate() for other types.
+   */
+  template <typename T, typename... Args> T *allocate(Args &&...args) {
+    static_assert(sizeof(T) <= ArenaAllocator::kMaxAllocationSize,
+                  "Object too large for arena allocation");
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "ConcurrentArena does not run destructors");
+
+    void *ptr = allocate(sizeof(T), alignof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+
+    return new (ptr) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * \brief Allocates an array of objects.
+   * \tparam T The type of objects to allocate
+   * \param count The number of objects to allocate
+   * \return A pointer to the allocated array.
+   * \throws std::bad_alloc if allocation fails.
+   * \warning Only supports trivially destructible types.
+   */
+  template <typename T> T *allocateArray(size_t count) {
+    static_assert(std::is_trivially_destructible_v<T>,
+                  "Arena arrays only support trivially destructible types");
+
+    if (count > ArenaAllocator::kMaxAllocationSize / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+
+    void *ptr = allocate(sizeof(T) * count, alignof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+
+    return static_cast<T *>(ptr);
+  }
+
+  /**
+   * \brief Allocates a string in the arena.
+   * \param str The string data
+   * \param length The length of the string
+   * \return A pointer to the allocated, null-terminated string.
+   */
+  char *allocateString(const char *str, size_t length);
+
+  /**
+   * \brief Allocates a null-terminated string in the arena.
+   * \param str The string data
+   * \return A pointer to the allocated string.
+   */
+  char *allocateString(const char *str) {
+    return allocateString(str, strlen(str));
+  }
+
+  /**
+   * \brief Abandons all thread regions and the current shared block.
+   * \details Must be called after the parent arena is reset, and before it
+   * is reused through this ConcurrentArena.
+   * \warning Not thread-safe; no other thread may allocate concurrently.
+   */
+  void reset();
+
+  /**
+   * \brief Gets the parent arena.
+   * \return The \ref ArenaAllocator that owns the memory
+   */
+  ArenaAllocator &getParent() const { return parent; }
+
+  /**
+   * \brief Gets allocation statistics.
+   * \return An \ref ArenaStats where \c allocatedCount is the memory taken
+   * from the parent, \c chunkCount the number of shared blocks,
+   * \c allocationCount the number of region refills and large allocations,
+   * and \c currentUsage the memory handed out to threads.
+   * \note Counters are updated per refill, not per allocation, so that the
+   * allocation fast path touches no shared state.
+   */
+  ArenaStats getStats() const;
+
+  /**
+   * \brief Prints statistics
+   * \param OS The output stream to print to
+   */
+  void printStats(std::ostream &OS) const;
+
+private:
+  /**
+   * \struct Block
+   * \brief Header of a shared block carved up between threads.
+   * \note Over-aligned so the data following it is suitably aligned.
+   */
+  struct alignas(ArenaAllocator::kDefaultAlignment) Block {
+    /**
+     * \brief The offset of the next free byte, bumped atomically.
+     */
+    std::atomic<size_t> offset;
+
+    /**
+     * \brief The number of usable bytes after the header.
+     */
+    size_t size;
+
+    char *getData() { return reinterpret_cast<char *>(this + 1); }
+  };
+
+  /**
+   * \brief Refills the calling thread's region and allocates from it.
+   * \param size The size of memory to allocate
+   * \param alignment The required alignment
+   * \return A pointer to the allocated memory or nullptr on failure.
+   */
+  void *allocateSlow(size_t size, size_t alignment);
+
+  /**
+   * \brief Carves \p size bytes out of the shared blocks.
+   * \param size The number of bytes to carve
+   * \return A pointer to the carved bytes or nullptr on failure.
+   */
+  char *carve(size_t size);
+
+  /**
+   * \brief Allocates directly from the parent under the lock.
+   * \param size The size of memory to allocate
+   * \param alignment The required alignment
+   * \return A pointer to the allocated memory or nullptr on failure.
+   */
+  void *allocateFromParent(size_t size, size_t alignment);
+
+  /**
+   * \brief The arena that owns all memory.
+   */
+  ArenaAllocator &parent;
+
+  /**
+   * \brief Mutex guarding access to the parent arena.
+   */
+  std::mutex Mutex;
+
+  /**
+   * \brief The block that regions are currently carved from.
+   */
+  std::atomic<Block *> currentBlock{nullptr};
+
+  /**
+   * \brief Identifies this arena's regions in thread-local storage.
+   * \details Unique across all ConcurrentArena instances and renewed on
+   * \ref reset(), so stale regions are never reused.
+   */
+  std::atomic<uint64_t> epoch;
+
+  /**
+   * \brief Bytes taken from the parent arena.
+   */
+  std::atomic<size_t> allocatedCount{0};
+
+  /**
+   * \brief Number of shared blocks taken from the parent arena.
+   */
+  std::atomic<size_t> blockCount{0};
+
+  /**
+   * \brief Number of region refills and direct parent allocations.
+   */
+  std::atomic<size_t> refillCount{0};
+
+  /**
+   * \brief Bytes handed out to threads.
+   */
+  std::atomic<size_t> handedOutCount{0};
+};
+
+/**
+ * \brief STL allocator drawing from a \ref ConcurrentArena.
+ * \tparam T The type of objects to allocate.
+ */
+template <typename T>
+using ConcurrentArenaSTLAllocator = ArenaSTLAllocator<T, ConcurrentArena>;
+
+/**
+ * \brief STL vector using concurrent arena allocation.
+ * \tparam T The type of objects in the vector.
+ */
+template <typename T>
+using ConcurrentArenaVector = std::vector<T, ConcurrentArenaSTLAllocator<T>>;
+
+} // namespace ml
\ No newline at end of file
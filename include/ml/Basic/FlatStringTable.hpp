@@ -0,0 +1,206 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string_view>
+
+namespace ml {
+
+/**
+ * \class FlatStringTable FlatStringTable.hpp "ml/Basic/FlatStringTable.hpp"
+ * \brief An open-addressing hash set of strings.
+ * \details Entries are stored inline as {pointer, length, hash} in one flat
+ * array, beside an array of one-byte control tags holding 7 bits of each
+ * entry's hash. A lookup loads a 16-slot group of tags and compares them
+ * all in one SIMD instruction; only slots whose tag matches are inspected,
+ * and the string bytes are compared only when the stored hash and length
+ * match too. Groups are probed triangularly until one has an empty slot.
+ *
+ * The table records strings but does not own them. Entries are never
+ * erased one by one, so there are no tombstones.
+ * \note Not thread-safe; \ref StringInterner locks around it.
+ */
+class FlatStringTable {
+public:
+  /**
+   * \struct Entry
+   * \brief A stored string.
+   */
+  struct Entry {
+    /**
+     * \brief The string bytes, or \c nullptr in an empty slot.
+     */
+    const char *data = nullptr;
+
+    /**
+     * \brief The string length in bytes.
+     */
+    uint32_t size = 0;
+
+    /**
+     * \brief The low 32 bits of the string's hash.
+     * \note Kept so that growing the table never rehashes the strings.
+     */
+    uint32_t hash = 0;
+
+    std::string_view view() const { return std::string_view(data, size); }
+  };
+
+  /**
+   * \brief The number of slots probed together.
+   */
+  static constexpr size_t kGroupSize = 16;
+
+  FlatStringTable() = default;
+
+  FlatStringTable(const FlatStringTable &) = delete;
+  FlatStringTable &operator=(const FlatStringTable &) = delete;
+
+  FlatStringTable(FlatStringTable &&other) noexcept;
+  FlatStringTable &operator=(FlatStringTable &&other) noexcept;
+
+  /**
+   * \brief Finds a string.
+   * \param str The string to find
+   * \param hash The string's hash
+   * \return The entry, or \c nullptr if the string is not in the table
+   */
+  const Entry *find(std::string_view str, size_t hash) const;
+
+  /**
+   * \brief Starts loading the slots a lookup for a hash would probe first.
+   * \param hash The string's hash
+   * \note A hint only; issue it a little before \ref find() so that
+   * several lookups overlap their cache misses.
+   */
+  void prefetch(size_t hash) const;
+
+  /**
+   * \brief Records a string that is not yet in the table.
+   * \param str The string; its bytes must outlive the table
+   * \param hash The string's hash, as later passed to \ref find()
+   * \return The new entry, valid until the table next grows
+   * \throws std::length_error if the string is 4 GiB or longer.
+   */
+  const Entry &insert(std::string_view str, size_t hash);
+
+  /**
+   * \brief Grows the table to hold a number of strings without rehashing.
+   * \param count The number of strings
+   */
+  void reserve(size_t count);
+
+  /**
+   * \brief Removes every entry and frees the arrays.
+   */
+  void clear();
+
+  size_t size() const { return Count; }
+  bool empty() const { return Count == 0; }
+
+  /**
+   * \brief Gets the number of slots.
+   * \return The capacity, zero or a power of two
+   */
+  size_t getCapacity() const { return Capacity; }
+
+  /**
+   * \brief Gets the bytes held by the slot and control arrays.
+   * \return The memory usage in bytes
+   */
+  size_t getMemoryUsage() const {
+    return Capacity * (sizeof(Entry) + sizeof(uint8_t));
+  }
+
+  /**
+   * \brief Finds the first occupied slot at or after a slot.
+   * \param slot The slot to start from
+   * \return The occupied slot, or \ref getCapacity() if there is none
+   */
+  size_t findOccupied(size_t slot) const;
+
+  /**
+   * \brief Gets the entry in a slot.
+   * \param slot A slot below \ref getCapacity()
+   * \return The entry; its \c data is \c nullptr if the slot is empty
+   */
+  const Entry &getEntry(size_t slot) const { return Slots[slot]; }
+
+  /**
+   * \class const_iterator
+   * \brief Iterates over the entries in slot order.
+   */
+  class const_iterator {
+  public:
+    using value_type = Entry;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const Entry *;
+    using reference = const Entry &;
+    using iterator_category = std::forward_iterator_tag;
+
+    const_iterator() = default;
+
+    reference operator*() const { return table->getEntry(slot); }
+    pointer operator->() const { return &table->getEntry(slot); }
+
+    const_iterator &operator++() {
+      slot = table->findOccupied(slot + 1);
+      return *this;
+    }
+
+    const_iterator operator++(int) {
+      const_iterator tmp = *this;
+      ++*this;
+      return tmp;
+    }
+
+    bool operator==(const const_iterator &other) const {
+      return table == other.table && slot == other.slot;
+    }
+    bool operator!=(const const_iterator &other) const {
+      return !(*this == other);
+    }
+
+  private:
+    friend class FlatStringTable;
+    const_iterator(const FlatStringTable *table, size_t slot)
+        : table(table), slot(slot) {}
+
+    const FlatStringTable *table = nullptr;
+    size_t slot = 0;
+  };
+
+  const_iterator begin() const { return const_iterator(this, findOccupied(0)); }
+  const_iterator end() const { return const_iterator(this, Capacity); }
+
+private:
+  /**
+   * \brief Finds the slot an entry with a hash would be inserted in.
+   * \param hash The stored hash
+   * \return An empty slot
+   */
+  size_t findEmptySlot(uint32_t hash) const;
+
+  /**
+   * \brief Moves every entry into arrays of a new capacity.
+   * \param newCapacity A power of two, at least \ref kGroupSize
+   */
+  void rehash(size_t newCapacity);
+
+  /**
+   * \brief The entries, \ref Capacity of them.
+   */
+  std::unique_ptr<Entry[]> Slots;
+
+  /**
+   * \brief One tag per slot: 7 hash bits, or the empty marker.
+   */
+  std::unique_ptr<uint8_t[]> Control;
+
+  size_t Capacity = 0;
+  size_t Count = 0;
+};
+
+} // namespace ml
@@ -0,0 +1,137 @@
+#pragma once
+
+#include "ml/Basic/StringInterner.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace ml {
+
+/**
+ * \class InternCache InternCache.hpp "ml/Basic/InternCache.hpp"
+ * \brief A small direct-mapped cache of interned strings in front of a
+ * \ref StringInterner.
+ * \details Source files repeat the same few identifiers over and over.
+ * Each slot remembers the last string that mapped to it, found by a hash
+ * of the length and three bytes of the string; a hit costs one slot load
+ * and one comparison, with no full hash, no lock and no shared cache line.
+ * A miss falls through to the interner and replaces the slot.
+ *
+ * The slots take 8 KiB, so the cache stays resident in L1 while a file is
+ * lexed.
+ * \note Not thread-safe; give each thread, e.g. each \c Lexer, its own.
+ * \warning Cached handles dangle once the interner is cleared; call
+ * \ref clear() too.
+ */
+class InternCache {
+public:
+  /**
+   * \brief log2 of \ref kSlotCount.
+   */
+  static constexpr unsigned kSlotBits = 9;
+
+  /**
+   * \brief The number of slots.
+   */
+  static constexpr size_t kSlotCount = size_t{1} << kSlotBits;
+
+  /**
+   * \brief Constructs an empty cache.
+   * \param interner The interner that misses go to
+   */
+  explicit InternCache(StringInterner &interner) : interner(&interner) {}
+
+  /**
+   * \brief Interns a string, answering from the cache when possible.
+   * \param str The string to intern
+   * \return The handle the interner gives \p str
+   */
+  InternedString intern(std::string_view str) {
+    InternedString cached = lookup(str);
+    if (cached.isValid()) {
+      return cached;
+    }
+
+    InternedString result = interner->intern(str);
+    insert(result);
+    return result;
+  }
+
+  /**
+   * \brief Looks a string up in the cache only, counting a hit or miss.
+   * \param str The string to look up
+   * \return The cached handle, or invalid if the slot holds another string
+   */
+  InternedString lookup(std::string_view str) {
+    const Slot &slot = Slots[getSlot(str)];
+    if (slot.length == str.size() && slot.str.isValid() &&
+        std::memcmp(slot.str.getData(), str.data(), str.size()) == 0) {
+      ++hitCount;
+      return slot.str;
+    }
+    ++missCount;
+    return InternedString();
+  }
+
+  /**
+   * \brief Caches a handle, replacing whatever shared its slot.
+   * \param str A handle from the cache's interner
+   */
+  void insert(InternedString str) {
+    std::string_view view = str.toStringView();
+    if (view.size() > UINT32_MAX) {
+      return;
+    }
+    Slot &slot = Slots[getSlot(view)];
+    slot.str = str;
+    slot.length = static_cast<uint32_t>(view.size());
+  }
+
+  /**
+   * \brief Forgets every cached handle; the counters are kept.
+   */
+  void clear() { Slots.fill(Slot{}); }
+
+  size_t getHitCount() const { return hitCount; }
+  size_t getMissCount() const { return missCount; }
+
+  StringInterner &getInterner() const { return *interner; }
+
+private:
+  /**
+   * \struct Slot
+   * \brief A cached handle and its length, checked before the bytes.
+   */
+  struct Slot {
+    InternedString str;
+    uint32_t length = 0;
+  };
+
+  /**
+   * \brief Picks a slot from the length and the first, middle and last
+   * bytes.
+   * \details Cheaper than a full hash; strings that share a slot only
+   * cost a miss.
+   */
+  static size_t getSlot(std::string_view str) {
+    size_t len = str.size();
+    uint64_t key = len;
+    if (len > 0) {
+      const auto *p = reinterpret_cast<const unsigned char *>(str.data());
+      key ^= (uint64_t{p[0]} << 8) | (uint64_t{p[len / 2]} << 16) |
+             (uint64_t{p[len - 1]} << 24);
+    }
+    // Fibonacci hashing spreads the key over the top bits
+    return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >>
+                               (64 - kSlotBits));
+  }
+
+  StringInterner *interner;
+  std::array<Slot, kSlotCount> Slots{};
+  size_t hitCount = 0;
+  size_t missCount = 0;
+};
+
+} // namespace ml
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \class LocalStringTable LocalStringTable.hpp "ml/Basic/LocalStringTable.hpp"
+ * \brief A private, single-threaded table numbering the strings of one
+ * lexing job.
+ * \details Gives each distinct string a dense local ID, 1, 2, 3, ... in
+ * order of first occurrence; ID 0 is the empty string, as in
+ * \ref StringInterner. The index is an open-addressing array of
+ * {hash, ID} pairs probed linearly, and the strings are recorded in an
+ * array in ID order, so there are no locks, no atomics and no copies.
+ *
+ * A parallel lexer interns into its own table, then the unique strings are
+ * merged into the shared interner in one batch and token symbols are
+ * remapped; the merge costs one lookup per unique string, not per token.
+ *
+ * The table records strings but does not own them.
+ * \note Not thread-safe; give each thread or job its own.
+ */
+class LocalStringTable {
+public:
+  LocalStringTable() = default;
+
+  LocalStringTable(const LocalStringTable &) = delete;
+  LocalStringTable &operator=(const LocalStringTable &) = delete;
+
+  LocalStringTable(LocalStringTable &&) noexcept = default;
+  LocalStringTable &operator=(LocalStringTable &&) noexcept = default;
+
+  /**
+   * \brief Numbers a string.
+   * \param str The string; its bytes must outlive the table
+   * \return The string's local ID, new if it was not seen before
+   * \throws std::length_error if the table would exceed 32-bit IDs.
+   */
+  uint32_t intern(std::string_view str);
+
+  /**
+   * \brief Gets the string of a local ID.
+   * \param id An ID below \ref getSymbolCount()
+   * \return The string
+   */
+  std::string_view getString(uint32_t id) const {
+    return id == 0 ? std::string_view() : Strings[id - 1];
+  }
+
+  /**
+   * \brief Gets the recorded strings.
+   * \return The strings in ID order; entry \c i has ID \c i+1
+   */
+  std::span<const std::string_view> getStrings() const { return Strings; }
+
+  /**
+   * \brief Gets one past the highest ID handed out.
+   * \return The size for a side table indexed by local ID
+   */
+  size_t getSymbolCount() const { return Strings.size() + 1; }
+
+  size_t size() const { return Strings.size(); }
+  bool empty() const { return Strings.empty(); }
+
+  /**
+   * \brief Forgets every string and frees the arrays.
+   */
+  void clear();
+
+private:
+  /**
+   * \struct Slot
+   * \brief An index slot.
+   */
+  struct Slot {
+    /**
+     * \brief The low 32 bits of the string's hash.
+     */
+    uint32_t hash = 0;
+
+    /**
+     * \brief The string's ID, or 0 in an empty slot.
+     */
+    uint32_t id = 0;
+  };
+
+  /**
+   * \brief Moves every slot into an index of a new capacity.
+   * \param newCapacity A power of two
+   */
+  void rehash(size_t newCapacity);
+
+  /**
+   * \brief The index, \ref Capacity slots, at most half full.
+   */
+  std::unique_ptr<Slot[]> Slots;
+
+  /**
+   * \brief The number of slots, zero or a power of two.
+   */
+  size_t Capacity = 0;
+
+  /**
+   * \brief The strings in ID order.
+   */
+  std::vector<std::string_view> Strings;
+};
+
+} // namespace ml
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \struct MemoryBudgetStats MemoryBudget.hpp "ml/Basic/MemoryBudget.hpp"
+ * \brief Statistics about a \ref MemoryBudget.
+ */
+struct MemoryBudgetStats {
+  /**
+   * \brief The configured limit in bytes.
+   */
+  size_t limit = 0;
+
+  /**
+   * \brief The bytes currently charged by all clients.
+   */
+  size_t usedBytes = 0;
+
+  /**
+   * \brief The highest value \ref usedBytes has reached.
+   */
+  size_t peakBytes = 0;
+
+  /**
+   * \brief The number of eviction callbacks invoked.
+   */
+  size_t evictionCount = 0;
+
+  /**
+   * \brief The bytes reported freed by eviction callbacks.
+   */
+  size_t evictedBytes = 0;
+
+  /**
+   * \brief The number of times the budget stayed exceeded after eviction.
+   */
+  size_t overflowCount = 0;
+};
+
+/**
+ * \class MemoryBudget MemoryBudget.hpp "ml/Basic/MemoryBudget.hpp"
+ * \brief Tracks live bytes across subsystems against one shared limit.
+ * \details Subsystems register as clients and charge the memory they hold.
+ * When a charge takes the total over the limit, clients that registered an
+ * eviction callback are asked to free memory, in registration order. If
+ * that is not enough the overflow handler is called once; it is called
+ * again only after usage has dropped back under the limit.
+ *
+ * The budget is soft: charges are always recorded and memory is never
+ * refused, so a subsystem that cannot degrade keeps working and the
+ * overflow is reported instead of the process crashing.
+ * \note Thread-safe. Charges and releases are lock-free unless the limit
+ * is exceeded.
+ * \warning Eviction callbacks run on the charging thread. Do not hold a
+ * lock your own eviction callback takes while charging.
+ */
+class MemoryBudget {
+public:
+  /**
+   * \brief Asks a client to free memory.
+   * \details Receives the number of bytes wanted and returns the number
+   * freed. The callback must \ref release() what it frees.
+   */
+  using EvictCallback = std::function<size_t(size_t)>;
+
+  class Client;
+
+  /**
+   * \brief Called when eviction cannot bring usage under the limit.
+   * \details Receives the client whose charge overflowed, the bytes in use
+   * and the limit.
+   */
+  using OverflowHandler =
+      std::function<void(const Client &, size_t used, size_t limit)>;
+
+  /**
+   * \class Client
+   * \brief A registered subsystem.
+   */
+  class Client {
+  public:
+    Client(std::string name, EvictCallback evict)
+        : name(std::move(name)), evict(std::move(evict)) {}
+
+    const std::string &getName() const { return name; }
+
+    /**
+     * \brief Gets the bytes this client currently holds.
+     * \return The charged bytes
+     */
+    size_t getUsedBytes() const {
+      return usedBytes.load(std::memory_order_relaxed);
+    }
+
+  private:
+    friend class MemoryBudget;
+
+    std::string name;
+    EvictCallback evict;
+    std::atomic<size_t> usedBytes{0};
+  };
+
+  /**
+   * \brief Constructs a budget.
+   * \param limit The limit in bytes; \c SIZE_MAX disables eviction and
+   * overflow reporting
+   */
+  explicit MemoryBudget(size_t limit = SIZE_MAX) : limit(limit) {}
+
+  MemoryBudget(const MemoryBudget &) = delete;
+  MemoryBudget &operator=(const MemoryBudget &) = delete;
+
+  /**
+   * \brief Registers a subsystem.
+   * \param name The name used in reports, e.g. \c "file_cache"
+   * \param evict Frees memory under pressure; empty if the client cannot
+   * \return The client handle, valid until \ref unregisterClient()
+   */
+  Client *registerClient(std::string name, EvictCallback evict = {});
+
+  /**
+   * \brief Unregisters a subsystem and releases its remaining charge.
+   * \param client A handle from \ref registerClient()
+   */
+  void unregisterClient(Client *client);
+
+  /**
+   * \brief Charges memory a client now holds.
+   * \param client The charging client
+   * \param bytes The number of bytes
+   * \return False if usage is still over the limit after eviction
+   */
+  bool charge(Client *client, size_t bytes) {
+    client->usedBytes.fetch_add(bytes, std::memory_order_relaxed);
+    size_t used = usedBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+    if (used > peakBytes.load(std::memory_order_relaxed)) {
+      updatePeak(used);
+    }
+    if (used <= limit.load(std::memory_order_relaxed)) {
+      return true;
+    }
+    return reclaim(*client);
+  }
+
+  /**
+   * \brief Releases memory a client no longer holds.
+   * \param client The releasing client
+   * \param bytes The number of bytes, at most what it charged
+   */
+  void release(Client *client, size_t bytes) {
+    client->usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    size_t used = usedBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    if (used - bytes <= limit.load(std::memory_order_relaxed)) {
+      overflowed.store(false, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * \brief Sets the limit.
+   * \param bytes The new limit in bytes
+   * \note Lowering the limit takes effect at the next charge.
+   */
+  void setLimit(size_t bytes) {
+    limit.store(bytes, std::memory_order_relaxed);
+  }
+
+  size_t getLimit() const { return limit.load(std::memory_order_relaxed); }
+
+  size_t getUsedBytes() const {
+    return usedBytes.load(std::memory_order_relaxed);
+  }
+
+  /**
+   * \brief Sets the handler called when the budget overflows.
+   * \param handler The handler, or empty to ignore overflows
+   * \details Overflows are reported once per episode, until usage falls
+   * back under the limit. An episode that began with no handler installed
+   * is reported at its next overflow once one is.
+   * \see DiagnosticManager::setMemoryBudget() for reporting them.
+   */
+  void setOverflowHandler(OverflowHandler handler);
+
+  /**
+   * \brief Gets the current statistics.
+   * \return The \ref MemoryBudgetStats
+   */
+  MemoryBudgetStats getStats() const;
+
+  /**
+   * \brief Prints statistics and per-client usage.
+   * \param OS The output stream to print to
+   */
+  void printStats(std::ostream &OS) const;
+
+private:
+  /**
+   * \brief Runs eviction after \p client pushed usage over the limit.
+   * \param client The client whose charge overflowed
+   * \return True if usage is back within the limit
+   */
+  bool reclaim(const Client &client);
+
+  /**
+   * \brief Raises \ref peakBytes to at least \p used.
+   * \param used The usage just observed
+   */
+  void updatePeak(size_t used);
+
+  std::atomic<size_t> limit;
+  std::atomic<size_t> usedBytes{0};
+  std::atomic<size_t> peakBytes{0};
+  std::atomic<bool> overflowed{false};
+
+  /**
+   * \brief Guards \ref Clients, the handler and the eviction counters.
+   */
+  mutable std::mutex Mutex;
+  std::vector<std::unique_ptr<Client>> Clients;
+  OverflowHandler overflowHandler;
+  size_t evictionCount = 0;
+  size_t evictedBytes = 0;
+  size_t overflowCount = 0;
+};
+
+} // namespace ml
@@ -0,0 +1,129 @@
+#pragma once
+
+#include "ml/Basic/FlatStringTable.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \class PerfectStringTable PerfectStringTable.hpp
+ * "ml/Basic/PerfectStringTable.hpp"
+ * \brief An immutable string set with a perfect hash function.
+ * \details Built once from a fixed set of strings by hash-and-displace:
+ * strings are grouped into small buckets, and each bucket is given a seed
+ * that sends all of its strings to distinct free slots. A lookup is one
+ * bucket load, one slot load and one comparison; it never probes, locks
+ * or writes.
+ *
+ * The table records strings but does not own them.
+ * \note Safe to read from any number of threads once built.
+ */
+class PerfectStringTable {
+public:
+  using Entry = FlatStringTable::Entry;
+
+  /**
+   * \struct Key
+   * \brief A string to build the table from.
+   */
+  struct Key {
+    /**
+     * \brief The string; its bytes must outlive the table.
+     */
+    std::string_view str;
+
+    /**
+     * \brief The string's full 64-bit hash.
+     */
+    uint64_t hash = 0;
+  };
+
+  /**
+   * \brief Builds a table.
+   * \param keys The strings, all distinct and shorter than 4 GiB
+   * \param rejected Receives the strings no seed could place, e.g. those
+   * whose full hashes collide; look them up elsewhere
+   * \return The table
+   */
+  static std::unique_ptr<PerfectStringTable> build(std::span<const Key> keys,
+                                                   std::vector<Key> &rejected);
+
+  /**
+   * \brief Finds a string.
+   * \param str The string to find
+   * \param hash The string's full hash
+   * \return The entry, or \c nullptr if the string is not in the table
+   */
+  const Entry *find(std::string_view str, uint64_t hash) const {
+    const Entry &entry = Slots[getSlot(hash, Seeds[getBucket(hash)])];
+    if (entry.data && entry.hash == static_cast<uint32_t>(hash) &&
+        entry.size == str.size() &&
+        std::memcmp(entry.data, str.data(), str.size()) == 0) {
+      return &entry;
+    }
+    return nullptr;
+  }
+
+  size_t size() const { return Count; }
+  bool empty() const { return Count == 0; }
+
+  /**
+   * \brief Gets the number of slots.
+   * \return The slot count, a power of two
+   */
+  size_t getCapacity() const { return SlotMask + 1; }
+
+  /**
+   * \brief Gets the bytes held by the seed and slot arrays.
+   * \return The memory usage in bytes
+   */
+  size_t getMemoryUsage() const {
+    return (BucketMask + 1) * sizeof(uint32_t) + getCapacity() * sizeof(Entry);
+  }
+
+  /**
+   * \brief Finds the first occupied slot at or after a slot.
+   * \param slot The slot to start from
+   * \return The occupied slot, or \ref getCapacity() if there is none
+   */
+  size_t findOccupied(size_t slot) const;
+
+  /**
+   * \brief Gets the entry in a slot.
+   * \param slot A slot below \ref getCapacity()
+   * \return The entry; its \c data is \c nullptr if the slot is empty
+   */
+  const Entry &getEntry(size_t slot) const { return Slots[slot]; }
+
+private:
+  PerfectStringTable() = default;
+
+  size_t getBucket(uint64_t hash) const {
+    // Fibonacci hashing; the slot function mixes the hash separately
+    return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >>
+                               BucketShift);
+  }
+
+  size_t getSlot(uint64_t hash, uint32_t seed) const {
+    uint64_t x = hash ^ (seed * 0xC2B2AE3D27D4EB4Full);
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    return static_cast<size_t>(x) & SlotMask;
+  }
+
+  std::unique_ptr<uint32_t[]> Seeds;
+  std::unique_ptr<Entry[]> Slots;
+  size_t BucketMask = 0;
+  unsigned BucketShift = 63;
+  size_t SlotMask = 0;
+  size_t Count = 0;
+};
+
+} // namespace ml
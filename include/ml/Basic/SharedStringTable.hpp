@@ -0,0 +1,174 @@
+#pragma once
+
+#include "ml/Basic/StringInterner.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+namespace ml {
+
+/**
+ * \class SharedStringTable SharedStringTable.hpp
+ * "ml/Basic/SharedStringTable.hpp"
+ * \brief An interner whose strings and index live in a file mapped by
+ * several processes at once.
+ * \details Cooperating worker processes open the same file and share one
+ * symbol space: a string interned by any of them gets the same
+ * \ref Symbol in all of them, and is found by the others without being
+ * hashed into a table of their own.
+ *
+ * The mapping holds a header, an array from symbol ID to string, an
+ * open-addressing index of {hash, ID} slots and an append-only string
+ * heap. A string is stored with an \ref InternedStringHeader just like a
+ * \ref StringInterner string, so handles are ordinary
+ * \ref InternedString values. Every shared word is a lock-free atomic, and
+ * a new string is published with one compare-and-swap on its index slot;
+ * no process ever waits for another, and a process that dies mid-insert
+ * leaves at most an unreachable copy in the heap.
+ *
+ * The capacity is fixed when the file is created; the index is kept at
+ * most half full, so probe runs stay short.
+ * \note Thread-safe, within and across processes.
+ * \warning Handles compare equal only within one mapping; compare
+ * symbols across processes, or across two tables opened on one file.
+ */
+class SharedStringTable {
+public:
+  /**
+   * \brief The number of strings a new file holds by default.
+   */
+  static constexpr uint32_t kDefaultMaxStrings = 1u << 20;
+
+  /**
+   * \brief The heap size of a new file by default.
+   */
+  static constexpr size_t kDefaultHeapSize = size_t{64} << 20;
+
+  ~SharedStringTable();
+
+  SharedStringTable(const SharedStringTable &) = delete;
+  SharedStringTable &operator=(const SharedStringTable &) = delete;
+
+  /**
+   * \brief Maps a table, creating the file if it does not exist.
+   * \param path The file to map
+   * \param maxStrings The string capacity if the file is created
+   * \param heapSize The heap size in bytes if the file is created
+   * \return The table, or an error if the file cannot be created or mapped
+   * or is not a valid table of the current version
+   * \details A new file is built beside \p path and linked into place
+   * without replacing anything, so a process racing to create the same
+   * table either wins or maps the winner's file; it never sees a partial
+   * one. An existing file keeps the capacity it was created with.
+   */
+  static std::pair<std::unique_ptr<SharedStringTable>, std::error_code>
+  open(const std::string &path, uint32_t maxStrings = kDefaultMaxStrings,
+       size_t heapSize = kDefaultHeapSize);
+
+  /**
+   * \brief Interns a string.
+   * \param str The string to intern
+   * \return The handle, pointing into this mapping
+   * \throws std::length_error if the table holds its maximum number of
+   * strings.
+   * \throws std::bad_alloc if the heap is full.
+   */
+  InternedString intern(std::string_view str);
+
+  /**
+   * \brief Looks up an interned string.
+   * \param str The string to look up
+   * \return The handle, or invalid if no process has interned \p str
+   */
+  InternedString lookup(std::string_view str) const;
+
+  /**
+   * \brief Checks if a string is interned.
+   * \param str The string to check
+   * \return True if any process has interned \p str
+   */
+  bool contains(std::string_view str) const {
+    return lookup(str).isValid();
+  }
+
+  /**
+   * \brief Gets the string of a symbol.
+   * \param symbol A symbol from this table, in any process
+   * \return The string, or invalid if the symbol is unknown
+   * \note O(1) and lock-free.
+   */
+  InternedString getString(Symbol symbol) const;
+
+  /**
+   * \brief Gets an upper bound for the symbol IDs handed out so far.
+   * \return One past the highest ID
+   */
+  size_t getSymbolCount() const;
+
+  /**
+   * \brief Gets the number of strings interned, by every process.
+   * \return The string count, the empty string excluded
+   */
+  size_t size() const;
+  bool empty() const { return size() == 0; }
+
+  /**
+   * \brief Gets the heap bytes used, by every process.
+   * \return The bytes used, wasted copies included
+   */
+  size_t getHeapUsed() const;
+
+  /**
+   * \brief Gets the size of the mapping.
+   * \return The file size in bytes
+   */
+  size_t getMappingSize() const { return mappingSize; }
+
+private:
+  SharedStringTable(char *data, size_t mappingSize)
+      : data(data), mappingSize(mappingSize) {}
+
+  /**
+   * \brief Gets the string recorded for a symbol ID.
+   * \param id The symbol ID
+   * \return The string's bytes, or \c nullptr if none is recorded
+   */
+  const char *getSymbolData(uint32_t id) const;
+
+  /**
+   * \brief Gets the string stored at a heap offset.
+   * \param offset The offset of its \ref InternedStringHeader
+   * \return The string's bytes
+   */
+  const char *getStringAt(uint64_t offset) const {
+    return data + offset + sizeof(InternedStringHeader);
+  }
+
+  /**
+   * \brief Probes the index for a string.
+   * \param str The string, not empty
+   * \param hash The string's hash
+   * \param slot Receives the slot where the probe stopped: the string's
+   * slot, or the empty slot it would take
+   * \return The string's bytes, or \c nullptr if it is not interned
+   */
+  const char *find(std::string_view str, uint64_t hash, size_t &slot) const;
+
+  /**
+   * \brief Copies a string into the heap and records it under a new
+   * symbol.
+   * \param str The string
+   * \param hash The string's hash
+   * \return The new symbol ID
+   */
+  uint32_t append(std::string_view str, uint64_t hash);
+
+  char *data;
+  size_t mappingSize;
+};
+
+} // namespace ml
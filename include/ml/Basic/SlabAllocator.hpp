@@ -0,0 +1,462 @@
+#pragma once
+
+#include "ml/Basic/ArenaAllocator.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iosfwd>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace ml {
+
+/**
+ * \struct SlabStats SlabAllocator.hpp "ml/Basic/SlabAllocator.hpp"
+ * \brief A container for statistics about \ref SlabAllocator usage.
+ * \details Mirrors \ref ArenaStats where the concepts overlap. Blocks
+ * are counted per call, so blocks cached in a thread's magazine count as
+ * free.
+ * \see SlabAllocator for usage context.
+ */
+struct SlabStats {
+
+  /**
+   * \brief The total bytes obtained for slabs.
+   */
+  size_t allocatedCount = 0;
+
+  /**
+   * \brief The number of slabs carved into blocks.
+   */
+  size_t slabCount = 0;
+
+  /**
+   * \brief The number of blocks handed out.
+   */
+  size_t allocationCount = 0;
+
+  /**
+   * \brief The number of blocks given back.
+   */
+  size_t deallocationCount = 0;
+
+  /**
+   * \brief The number of requests served by the general heap.
+   * \details Requests larger than the largest size class, or with an
+   * alignment above \ref ArenaAllocator::kDefaultAlignment.
+   */
+  size_t largeAllocationCount = 0;
+
+  /**
+   * \brief The peak number of block bytes in use.
+   */
+  size_t peakUsage = 0;
+
+  /**
+   * \brief The number of block bytes currently in use.
+   */
+  size_t currentUsage = 0;
+
+  /**
+   * \brief Gets the fraction of slab memory currently in use.
+   * \return Utilization ratio as a double in [0.0, 1.0]
+   */
+  double getUtilization() const {
+    return allocatedCount > 0 ? static_cast<double>(currentUsage) /
+                                    static_cast<double>(allocatedCount)
+                              : 0.0;
+  }
+};
+
+/**
+ * \class SlabAllocator SlabAllocator.hpp "ml/Basic/SlabAllocator.hpp"
+ * \brief A size-class allocator supporting individual deallocation.
+ * \details Rounds each request up to a size class and serves it from an
+ * intrusive free list of equally sized blocks. Free lists are refilled by
+ * carving slabs out of an internal \ref ArenaAllocator. Each thread keeps
+ * a small magazine of blocks per size class, so most allocations and
+ * deallocations touch no shared state; magazines are exchanged with the
+ * shared free lists in batches.
+ *
+ * Memory is only returned to the system when the allocator is destroyed.
+ * \note Thread-safe for concurrent access.
+ * \see ArenaAllocator for bulk allocation without individual deallocation.
+ */
+class SlabAllocator {
+public:
+  /**
+   * \brief The default slab size. (64KB)
+   */
+  static constexpr size_t kDefaultSlabSize = 64 * 1024;
+
+  /**
+   * \brief The smallest block size; all size classes are multiples of it.
+   */
+  static constexpr size_t kMinBlockSize = ArenaAllocator::kDefaultAlignment;
+
+  /**
+   * \brief The largest default size class. (4KB)
+   */
+  static constexpr size_t kMaxDefaultBlockSize = 4096;
+
+  /**
+   * \brief The number of blocks moved between a magazine and a free list.
+   */
+  static constexpr size_t kMagazineSize = 32;
+
+  /**
+   * \brief Constructs a SlabAllocator with power-of-two size classes.
+   * \param slabSize The size of each slab carved into blocks
+   * \details Size classes range from \ref kMinBlockSize to
+   * \ref kMaxDefaultBlockSize.
+   */
+  explicit SlabAllocator(size_t slabSize = kDefaultSlabSize);
+
+  /**
+   * \brief Constructs a SlabAllocator with custom size classes.
+   * \param sizeClasses The block sizes to use
+   * \param slabSize The size of each slab carved into blocks
+   * \details Sizes are rounded up to a multiple of \ref kMinBlockSize,
+   * sorted and deduplicated. Sizes larger than \p slabSize are ignored.
+   * \throws std::invalid_argument if 255 or more distinct sizes remain.
+   */
+  SlabAllocator(std::vector<size_t> sizeClasses,
+                size_t slabSize = kDefaultSlabSize);
+
+  ~SlabAllocator();
+
+  /**
+   * \brief Non-copyable SlabAllocator.
+   * \details Threads identify their magazines by allocator, so the
+   * allocator must stay at a fixed address.
+   */
+  SlabAllocator(const SlabAllocator &) = delete;
+
+  /**
+   * \brief Non-copyable assignment operator.
+   * \see SlabAllocator(const SlabAllocator &)
+   */
+  SlabAllocator &operator=(const SlabAllocator &) = delete;
+
+  /**
+   * \brief Allocates a block.
+   * \param size The size of memory to allocate
+   * \param alignment The required alignment
+   * \return A pointer to the allocated memory or nullptr if allocation fails.
+   */
+  void *allocate(size_t size,
+                 size_t alignment = ArenaAllocator::kDefaultAlignment);
+
+  /**
+   * \brief Returns a block to the allocator.
+   * \param ptr The pointer returned by \ref allocate()
+   * \param size The size passed to \ref allocate()
+   * \param alignment The alignment passed to \ref allocate()
+   * \warning \p size and \p alignment must match the original request.
+   */
+  void deallocate(void *ptr, size_t size,
+                  size_t alignment = ArenaAllocator::kDefaultAlignment);
+
+  /**
+   * \brief Allocates and constructs an object of type T.
+   * \tparam T The type of object to allocate
+   * \tparam Args The constructor argument types
+   * \param args The constructor arguments
+   * \return A pointer to the constructed object.
+   * \throws std::bad_alloc if allocation fails.
+   * \see destroy() to release the object.
+   */
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    void *ptr = allocate(sizeof(T), alignof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+
+    return new (ptr) T(std::forward<Args>(args)...);
+  }
+
+  /**
+   * \brief Destroys and deallocates an object created by \ref create().
+   * \tparam T The type of object
+   * \param object The object to destroy
+   */
+  template <typename T> void destroy(T *object) {
+    if (object) {
+      object->~T();
+      deallocate(object, sizeof(T), alignof(T));
+    }
+  }
+
+  /**
+   * \brief Returns the calling thread's cached blocks to the shared lists.
+   * \details Called automatically when a thread exits.
+   */
+  void flushThreadCache();
+
+  /**
+   * \brief Gets the number of size classes.
+   * \return The size class count
+   */
+  size_t getSizeClassCount() const { return classCount; }
+
+  /**
+   * \brief Gets the block size of a size class.
+   * \param index The size class index
+   * \return The block size in bytes
+   */
+  size_t getSizeClass(size_t index) const { return Classes[index].blockSize; }
+
+  /**
+   * \brief Gets the slab size.
+   * \return The slab size in bytes
+   */
+  size_t getSlabSize() const { return slabSize; }
+
+  /**
+   * \brief Gets the current allocation statistics.
+   * \return The current \ref SlabStats.
+   */
+  SlabStats getStats() const;
+
+  /**
+   * \brief Prints statistics
+   * \param OS The output stream to print to
+   */
+  void printStats(std::ostream &OS) const;
+
+private:
+  friend struct SlabThreadCache;
+
+  /**
+   * \struct FreeNode
+   * \brief An intrusive free list link stored inside a free block.
+   */
+  struct FreeNode {
+    FreeNode *next;
+  };
+
+  /**
+   * \struct Magazine
+   * \brief A thread-local stack of free blocks for one size class.
+   */
+  struct Magazine {
+    FreeNode *head = nullptr;
+    size_t count = 0;
+  };
+
+  /**
+   * \struct SizeClass
+   * \brief The shared free list of one size class.
+   */
+  struct SizeClass {
+    size_t blockSize = 0;
+    mutable std::mutex Mutex;
+    FreeNode *freeList = nullptr;
+    size_t slabCount = 0;
+    std::atomic<size_t> allocationCount{0};
+    std::atomic<size_t> deallocationCount{0};
+  };
+
+  /**
+   * \brief Builds the size lookup table and registers the allocator.
+   * \param sizeClasses The requested block sizes
+   */
+  void initialize(std::vector<size_t> sizeClasses);
+
+  /**
+   * \brief Maps a request size to its size class.
+   * \param size The request size
+   * \return The size class index, or \ref classCount if too large
+   */
+  size_t getClassIndex(size_t size) const {
+    size_t slot = (size + kMinBlockSize - 1) / kMinBlockSize;
+    return slot < ClassIndex.size() ? ClassIndex[slot] : classCount;
+  }
+
+  /**
+   * \brief Gets the calling thread's magazines for this allocator.
+   * \return The magazines, one per size class
+   */
+  Magazine *getMagazines();
+
+  /**
+   * \brief Moves a batch of blocks from the shared list into a magazine.
+   * \param index The size class index
+   * \param magazine The magazine to fill
+   * \return True if at least one block was moved
+   */
+  bool refill(size_t index, Magazine &magazine);
+
+  /**
+   * \brief Moves blocks from a magazine back to the shared list.
+   * \param index The size class index
+   * \param magazine The magazine to drain
+   * \param count The number of blocks to move
+   */
+  void flush(size_t index, Magazine &magazine, size_t count);
+
+  /**
+   * \brief Carves a new slab into the free list of a size class.
+   * \param sizeClass The size class to grow; its mutex must be held
+   * \return True if the slab was allocated
+   */
+  bool carveSlab(SizeClass &sizeClass);
+
+  /**
+   * \brief Adds to the in-use byte counter and updates the peak.
+   * \param bytes The number of bytes taken into use
+   */
+  void recordUsage(size_t bytes);
+
+  /**
+   * \brief The size classes, smallest first.
+   */
+  std::unique_ptr<SizeClass[]> Classes;
+
+  /**
+   * \brief The number of size classes.
+   */
+  size_t classCount = 0;
+
+  /**
+   * \brief Maps a request size in \ref kMinBlockSize units to a class.
+   */
+  std::vector<uint8_t> ClassIndex;
+
+  /**
+   * \brief The size of each slab.
+   */
+  size_t slabSize;
+
+  /**
+   * \brief The arena slabs are carved from.
+   * \details Slab accounting is kept in \ref SlabStats, so the arena
+   * records no statistics of its own.
+   */
+  BasicArenaAllocator<ArenaNoStats> arena;
+
+  /**
+   * \brief Mutex guarding access to the arena.
+   */
+  std::mutex ArenaMutex;
+
+  /**
+   * \brief Identifies this allocator's magazines in thread-local storage.
+   */
+  uint64_t epoch;
+
+  /**
+   * \brief Block bytes currently in use.
+   */
+  std::atomic<size_t> currentUsage{0};
+
+  /**
+   * \brief The peak of \ref currentUsage.
+   */
+  std::atomic<size_t> peakUsage{0};
+
+  /**
+   * \brief Requests served by the general heap.
+   */
+  std::atomic<size_t> largeAllocationCount{0};
+};
+
+/**
+ * \class SlabSTLAllocator SlabAllocator.hpp "ml/Basic/SlabAllocator.hpp"
+ * \brief STL-compatible allocator using \ref SlabAllocator.
+ * \tparam T The type of objects to allocate.
+ * \details Unlike \ref ArenaSTLAllocator, memory released by the container
+ * is returned to the slab allocator and reused.
+ */
+template <typename T> class SlabSTLAllocator {
+public:
+  using value_type = T;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  /**
+   * \brief Rebind allocator to another type U.
+   * \tparam U The new type to bind to.
+   */
+  template <typename U> struct rebind {
+    using other = SlabSTLAllocator<U>;
+  };
+
+  explicit SlabSTLAllocator(SlabAllocator &slab) : slab(&slab) {}
+
+  template <typename U>
+  SlabSTLAllocator(const SlabSTLAllocator<U> &other) : slab(other.slab) {}
+
+  /**
+   * \brief Allocates memory for n objects of type T.
+   * \param n The number of objects to allocate.
+   * \return A pointer to the allocated memory.
+   * \throw std::bad_alloc if allocation fails.
+   */
+  T *allocate(size_type n) {
+    if (n > SIZE_MAX / sizeof(T)) {
+      throw std::bad_alloc();
+    }
+
+    void *ptr = slab->allocate(n * sizeof(T), alignof(T));
+    if (!ptr) {
+      throw std::bad_alloc();
+    }
+
+    return static_cast<T *>(ptr);
+  }
+
+  /**
+   * \brief Deallocates memory for n objects of type T.
+   * \param ptr Pointer to the memory to deallocate.
+   * \param n The number of objects to deallocate.
+   */
+  void deallocate(T *ptr, size_type n) {
+    slab->deallocate(ptr, n * sizeof(T), alignof(T));
+  }
+
+  template <typename U>
+  bool operator==(const SlabSTLAllocator<U> &other) const {
+    return slab == other.slab;
+  }
+
+  template <typename U>
+  bool operator!=(const SlabSTLAllocator<U> &other) const {
+    return !(*this == other);
+  }
+
+private:
+  template <typename U> friend class SlabSTLAllocator;
+  SlabAllocator *slab;
+};
+
+/// Convenience aliases for STL containers with slab allocation
+
+/**
+ * \brief STL vector using slab allocation.
+ * \tparam T The type of objects in the vector.
+ */
+template <typename T> using SlabVector = std::vector<T, SlabSTLAllocator<T>>;
+
+/**
+ * \brief STL deque using slab allocation.
+ * \tparam T The type of objects in the deque.
+ */
+template <typename T> using SlabDeque = std::deque<T, SlabSTLAllocator<T>>;
+
+/**
+ * \brief STL list using slab allocation.
+ * \tparam T The type of objects in the list.
+ */
+template <typename T> using SlabList = std::list<T, SlabSTLAllocator<T>>;
+
+} // namespace ml
\ No newline at end of file
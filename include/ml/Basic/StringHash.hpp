@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#if defined(_MSC_VER) && defined(_M_X64) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace ml {
+
+/**
+ * \struct StringHash StringHash.hpp "ml/Basic/StringHash.hpp"
+ * \brief The string hash used throughout the compiler.
+ * \details A wyhash-style function: 8-byte loads folded by 64x64->128-bit
+ * multiplies, with three independent lanes for long strings. Identifiers
+ * of up to 16 bytes, the common case, cost two overlapping loads and two
+ * multiplies with no loop or branch on the exact length.
+ *
+ * The seed is fixed, so a string hashes the same in every run and every
+ * build on the same byte order; hashes may be stored, e.g. in snapshots.
+ * Every bit of the result is well mixed, so tables may take their bucket
+ * from the low bits and a tag or shard from the high bits.
+ * \note Usable directly as the hasher of unordered containers; it is
+ * transparent, so \c std::string keys can be probed with views.
+ */
+struct StringHash {
+  using is_transparent = void;
+
+  /**
+   * \brief The default seed.
+   */
+  static constexpr uint64_t kDefaultSeed = 0x9E3779B97F4A7C15ull;
+
+  /**
+   * \brief Hashes a string.
+   * \param str The string to hash
+   * \param seed The seed; strings hashed with different seeds are
+   * unrelated
+   * \return The 64-bit hash
+   */
+  static uint64_t hash(std::string_view str, uint64_t seed = kDefaultSeed) {
+    const auto *p = reinterpret_cast<const unsigned char *>(str.data());
+    size_t len = str.size();
+    seed ^= mix(seed ^ kSecret[0], kSecret[1]);
+
+    uint64_t a = 0;
+    uint64_t b = 0;
+    if (len <= 16) {
+      if (len >= 4) {
+        // Two pairs of overlapping 4-byte loads cover 4 to 16 bytes
+        size_t shift = (len >> 3) << 2;
+        a = (read32(p) << 32) | read32(p + shift);
+        b = (read32(p + len - 4) << 32) | read32(p + len - 4 - shift);
+      } else if (len > 0) {
+        a = (uint64_t{p[0]} << 16) | (uint64_t{p[len >> 1]} << 8) |
+            p[len - 1];
+      }
+    } else {
+      size_t i = len;
+      if (i > 48) {
+        uint64_t lane1 = seed;
+        uint64_t lane2 = seed;
+        do {
+          seed = mix(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+          lane1 = mix(read64(p + 16) ^ kSecret[2], read64(p + 24) ^ lane1);
+          lane2 = mix(read64(p + 32) ^ kSecret[3], read64(p + 40) ^ lane2);
+          p += 48;
+          i -= 48;
+        } while (i > 48);
+        seed ^= lane1 ^ lane2;
+      }
+      while (i > 16) {
+        seed = mix(read64(p) ^ kSecret[1], read64(p + 8) ^ seed);
+        p += 16;
+        i -= 16;
+      }
+      // The last 16 bytes, overlapping what was already consumed
+      a = read64(p + i - 16);
+      b = read64(p + i - 8);
+    }
+
+    a ^= kSecret[1];
+    b ^= seed;
+    multiply(a, b);
+    return mix(a ^ kSecret[0] ^ len, b ^ kSecret[1]);
+  }
+
+  size_t operator()(std::string_view str) const {
+    return static_cast<size_t>(hash(str));
+  }
+
+private:
+  static constexpr uint64_t kSecret[4] = {
+      0x2D358DCCAA6C78A5ull, 0x8BB84B93962EACC9ull, 0x4B33A62ED433D4A3ull,
+      0x4D5A2DA51DE1AA47ull};
+
+  static uint64_t read64(const unsigned char *p) {
+    uint64_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  static uint64_t read32(const unsigned char *p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+  }
+
+  /**
+   * \brief Replaces \p a and \p b by the low and high halves of their
+   * 128-bit product.
+   */
+  static void multiply(uint64_t &a, uint64_t &b) {
+#if defined(__SIZEOF_INT128__)
+    __extension__ using uint128 = unsigned __int128;
+    uint128 product = static_cast<uint128>(a) * b;
+    a = static_cast<uint64_t>(product);
+    b = static_cast<uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    uint64_t aHi = a >> 32, aLo = a & 0xFFFFFFFF;
+    uint64_t bHi = b >> 32, bLo = b & 0xFFFFFFFF;
+    uint64_t hiHi = aHi * bHi, hiLo = aHi * bLo;
+    uint64_t loHi = aLo * bHi, loLo = aLo * bLo;
+    uint64_t mid = hiLo + (loLo >> 32) + (loHi & 0xFFFFFFFF);
+    a = (mid << 32) | (loLo & 0xFFFFFFFF);
+    b = hiHi + (mid >> 32) + (loHi >> 32);
+#endif
+  }
+
+  static uint64_t mix(uint64_t a, uint64_t b) {
+    multiply(a, b);
+    return a ^ b;
+  }
+};
+
+} // namespace ml
@@ -1,20 +1,143 @@
 #pragma once
 
+#include "ml/Basic/ArenaAllocator.hpp"
+#include "ml/Basic/ArenaSnapshot.hpp"
+#include "ml/Basic/FlatStringTable.hpp"
+#include "ml/Basic/MemoryBudget.hpp"
+#include "ml/Basic/PerfectStringTable.hpp"
+#include "ml/Basic/StringHash.hpp"
 #include <atomic>
 #include <cstdint>
 #include <iosfwd>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <span>
 #include <string.h>
 #include <string>
 #include <string_view>
-#include <unordered_map>
-#include <unordered_set>
+#include <utility>
 
 namespace ml {
 
-class ArenaAllocator;
+class ConcurrentArena;
+
+/**
+ * \struct StringTableImage StringInterner.hpp "ml/Basic/StringInterner.hpp"
+ * \brief The interned strings of a \ref StringInterner in a snapshot.
+ * \see StringInterner::writeSnapshot() and StringInterner::loadSnapshot().
+ */
+struct StringTableImage {
+  /**
+   * \struct Entry
+   * \brief One interned string.
+   * \details Entries are linked so the table is not bound by the arena's
+   * maximum allocation size. Each string is preceded by its
+   * \ref InternedStringHeader in the image.
+   */
+  struct Entry {
+    SnapshotString string;
+    OffsetPtr<const Entry> next;
+  };
+
+  uint64_t count = 0;
+  OffsetPtr<const Entry> first;
+};
+
+/**
+ * \class Symbol StringInterner.hpp "ml/Basic/StringInterner.hpp"
+ * \brief A dense 32-bit ID for an interned string.
+ * \details Each \ref StringInterner numbers its strings sequentially from
+ * 1; ID 0 is the empty string. Symbols are half the size of an
+ * \ref InternedString and index side tables directly, so per-symbol data
+ * can live in flat vectors and bitsets instead of hash maps.
+ * \see StringInterner::getString() for the string of a symbol.
+ * \note Symbols from different interners are not comparable.
+ */
+class Symbol {
+public:
+  /**
+   * \brief The ID of an invalid symbol.
+   */
+  static constexpr uint32_t kInvalidID = UINT32_MAX;
+
+  Symbol() = default;
+
+  /**
+   * \brief Constructs a symbol from its ID.
+   * \param id The ID, e.g. an index into a side table
+   */
+  explicit Symbol(uint32_t id) : id(id) {}
+
+  uint32_t getID() const { return id; }
+
+  /**
+   * \brief Checks if the symbol is valid.
+   * \return \c false for a default-constructed symbol, \c true otherwise.
+   */
+  bool isValid() const { return id != kInvalidID; }
+
+  bool operator==(const Symbol &other) const { return id == other.id; }
+  bool operator!=(const Symbol &other) const { return id != other.id; }
+  bool operator<(const Symbol &other) const { return id < other.id; }
+
+private:
+  uint32_t id = kInvalidID;
+};
+
+/**
+ * \struct InternedStringHeader StringInterner.hpp
+ * "ml/Basic/StringInterner.hpp"
+ * \brief The length and content hash stored just before the bytes of every
+ * interned string.
+ * \details Lets \ref InternedString answer \ref InternedString::length()
+ * and \ref InternedString::getHashValue() with a single load.
+ */
+struct InternedStringHeader {
+  /**
+   * \brief The content hash, as computed by \ref computeHash().
+   */
+  uint64_t hash = 0;
+
+  /**
+   * \brief The string length in bytes, excluding the null terminator.
+   */
+  uint32_t length = 0;
+
+  /**
+   * \brief The string's \ref Symbol ID in its interner.
+   */
+  uint32_t id = 0;
+
+  /**
+   * \brief Hashes string content the way the interner does.
+   * \param str The string to hash
+   * \return The hash stored in the header of \p str once interned
+   * \note Use it to probe maps keyed by interned strings' hashes. Equal
+   * to \ref StringHash::hash() with the default seed.
+   */
+  static uint64_t computeHash(std::string_view str) {
+    return StringHash::hash(str);
+  }
+
+  /**
+   * \brief Gets the header of an interned string.
+   * \param data The interned string's bytes
+   * \return The header just before them
+   */
+  static const InternedStringHeader *fromData(const char *data) {
+    return reinterpret_cast<const InternedStringHeader *>(data) - 1;
+  }
+
+  /**
+   * \brief Gets the bytes following the header.
+   * \return The null-terminated string
+   */
+  const char *getData() const {
+    return reinterpret_cast<const char *>(this + 1);
+  }
+};
 
 /**
  * \class InternedString StringInterner.hpp "ml/Basic/StringInterner.hpp"
@@ -50,7 +173,7 @@ public:
    * \note Returns empty view if data is a \c nullptr value.
    */
   std::string_view toStringView() const {
-    return ptr ? std::string_view(ptr) : std::string_view();
+    return ptr ? std::string_view(ptr, length()) : std::string_view();
   }
 
   /**
@@ -64,8 +187,11 @@ public:
   /**
    * \brief Gets the string length.
    * \return Length in characters.
+   * \note Reads the stored length; O(1).
    */
-  size_t length() const { return ptr ? strlen(ptr) : 0; }
+  size_t length() const {
+    return ptr ? InternedStringHeader::fromData(ptr)->length : 0;
+  }
 
   /**
    * \brief Checks if the string is empty.
@@ -110,10 +236,22 @@ public:
 
   /**
    * \brief Gets the hash value of the string.
-   * \return The hash value of the underlying data.
-   * \note Hash is pointer-based for fast lookup in hash tables.
+   * \return The content hash stored with the string, or 0 if invalid.
+   * \note Equal to \ref InternedStringHeader::computeHash() of the content,
+   * so maps keyed by interned strings can be probed with plain strings.
+   */
+  size_t getHashValue() const {
+    return ptr ? static_cast<size_t>(InternedStringHeader::fromData(ptr)->hash)
+               : 0;
+  }
+
+  /**
+   * \brief Gets the string's symbol.
+   * \return The \ref Symbol stored with the string, or an invalid symbol.
    */
-  size_t getHashValue() const { return std::hash<const char *>{}(ptr); }
+  Symbol getSymbol() const {
+    return ptr ? Symbol(InternedStringHeader::fromData(ptr)->id) : Symbol();
+  }
 
   /**
    * \brief Converts to a string.
@@ -128,11 +266,13 @@ public:
   operator std::string_view() const { return toStringView(); }
 
 private:
+  friend class SharedStringTable;
   friend class StringInterner;
 
   /**
    * \brief Constructs an \c InternedString from a raw pointer.
    * \param ptr The pointer to the interned string data.
+   * \note The data must follow an \ref InternedStringHeader.
    */
   explicit InternedString(const char *ptr) : ptr(ptr) {}
 
@@ -147,8 +287,8 @@ private:
  * \struct StringInternerStats "StringInterner.hpp"
  * "ml/Basic/StringInterner.hpp"
  * \brief Statistics about the StringInterner.
- * \details Tracks various metrics such as number of interned strings,
- * memory usage, and collision counts.
+ * \details Tracks various metrics such as number of interned strings and
+ * memory usage.
  * \see StringInterner::getStats() for retrieving statistics.
  */
 struct StringInternerStats {
@@ -160,14 +300,10 @@ struct StringInternerStats {
 
   /**
    * \brief Total number of lookup operations.
+   * \note Lookups answered by the frozen table are not counted.
    */
   size_t lookupCount = 0;
 
-  /**
-   * \brief Number of hash collisions encountered.
-   */
-  size_t collisionCount = 0;
-
   /**
    * \brief Total memory used for storing interned strings (in bytes).
    */
@@ -194,6 +330,8 @@ struct InternedStringHash {
    * \brief Computes the hash value for an InternedString.
    * \param str The InternedString to hash.
    * \return The hash value.
+   * \note Reads the \ref StringHash stored when the string was interned,
+   * so the content is never hashed twice.
    */
   size_t operator()(const InternedString &str) const {
     return str.getHashValue();
@@ -208,7 +346,9 @@ struct InternedStringHash {
  * optional arena allocation for improved memory locality through the \ref
  * ArenaAllocator.
  * \see InternedString for the interned string handle.
- * \note Thread-safe for concurrent access.
+ * \note Thread-safe for concurrent access. Strings are spread over
+ * independently locked shards, so threads lexing different files rarely
+ * wait on each other.
  * \warning \ref InternedString objects become invalid after \ref clear() is
  * called.
  */
@@ -228,6 +368,15 @@ public:
    */
   explicit StringInterner(ArenaAllocator &arena);
 
+  /**
+   * \brief Constructs a StringInterner with a ConcurrentArena.
+   * \param arena The ConcurrentArena to use for string storage.
+   * \details Use this when other threads allocate from the same parent
+   * arena, e.g. during parallel lexing.
+   * \see ConcurrentArena for thread-safe arena allocation.
+   */
+  explicit StringInterner(ConcurrentArena &arena);
+
   ~StringInterner();
 
   /**
@@ -293,6 +442,46 @@ public:
     return intern(std::string_view(str, len));
   }
 
+  /**
+   * \brief Interns many strings at once.
+   * \param strs The strings to intern.
+   * \param out Receives the handle of each string, at the same index.
+   * \details Hashes every string up front, then visits each shard once
+   * with the table slots of all its strings prefetched, taking its lock
+   * once for the lookups and once more only if some strings are new.
+   * Duplicates within the batch get the same handle.
+   * \throws std::length_error if \p out is shorter than \p strs.
+   * \see intern(std::string_view) for a single string.
+   */
+  void internBatch(std::span<const std::string_view> strs,
+                   std::span<InternedString> out);
+
+  /**
+   * \brief Interns a string and returns its symbol.
+   * \param str The string to intern.
+   * \return The symbol of the interned string.
+   */
+  Symbol internSymbol(std::string_view str) {
+    return intern(str).getSymbol();
+  }
+
+  /**
+   * \brief Gets the string of a symbol.
+   * \param symbol A symbol from this interner.
+   * \return The interned string, or invalid if the symbol is unknown.
+   * \note O(1) and lock-free.
+   */
+  InternedString getString(Symbol symbol) const;
+
+  /**
+   * \brief Gets an upper bound for the symbol IDs handed out so far.
+   * \return One past the highest ID; the size for a side table indexed by
+   * \ref Symbol::getID()
+   */
+  size_t getSymbolCount() const {
+    return nextSymbol.load(std::memory_order_acquire);
+  }
+
   /**
    * \brief Looks up an interned string.
    * \param str The string to look up.
@@ -346,6 +535,46 @@ public:
    */
   void reserve(size_t count);
 
+  /**
+   * \brief Moves every interned string into an immutable table.
+   * \details The table has a perfect hash function, so strings interned
+   * so far are found with no lock, atomic or probe. Strings interned
+   * afterwards go to the regular sharded tables, which now act as a small
+   * mutable overlay. Freezing again folds the overlay in.
+   * \note Handles and symbols stay valid.
+   * \warning Must not run concurrently with any other member function.
+   */
+  void freeze();
+
+  /**
+   * \brief Checks if \ref freeze() has been called since the last
+   * \ref clear().
+   * \return True if a frozen table exists, false otherwise.
+   */
+  bool isFrozen() const { return Frozen != nullptr; }
+
+  /**
+   * \brief Copies every interned string into a snapshot.
+   * \param writer The snapshot being built
+   * \return The table, to be linked from the snapshot's root
+   * \throws std::bad_alloc if the image cannot grow.
+   */
+  const StringTableImage *writeSnapshot(ArenaSnapshotWriter &writer) const;
+
+  /**
+   * \brief Interns every string of a snapshot table without copying.
+   * \param table A table in a mapped \ref ArenaSnapshot
+   * \details Strings already interned keep their current handles; the rest
+   * point straight into the mapping and keep the symbol they had when the
+   * image was written. A string whose symbol is already taken is copied
+   * and numbered afresh, so loading into an empty interner preserves every
+   * symbol. A recorded symbol beyond the image's string count is corrupt,
+   * and its string is copied too.
+   * \warning The snapshot must outlive the interner and every handle it
+   * returns.
+   */
+  void loadSnapshot(const StringTableImage &table);
+
   /**
    * \brief Gets the total memory usage of the interner.
    * \return The total memory used in bytes.
@@ -356,17 +585,71 @@ public:
    * \brief Checks if the interner is using an arena allocator.
    * \return True if using an arena allocator, false otherwise.
    */
-  bool isUsingArena() const { return arenaAllocator != nullptr; }
+  bool isUsingArena() const {
+    return arenaAllocator != nullptr || concurrentArena != nullptr;
+  }
 
   /**
    * \brief Gets the associated ArenaAllocator.
    * \return Pointer to the ArenaAllocator, or nullptr if not using one.
+   * \note Returns nullptr when using a \ref ConcurrentArena.
    */
   ArenaAllocator *getArena() const { return arenaAllocator; }
 
+  /**
+   * \brief Gets the associated ConcurrentArena.
+   * \return Pointer to the ConcurrentArena, or nullptr if not using one.
+   */
+  ConcurrentArena *getConcurrentArena() const { return concurrentArena; }
+
+  /**
+   * \brief Charges the interner's memory to a budget.
+   * \param budget The budget, or \c nullptr to detach
+   * \details Table entries are charged, plus the string bytes when they
+   * are not already charged through an arena.
+   * \note Call before the interner is shared between threads.
+   */
+  void setMemoryBudget(MemoryBudget *budget);
+
+  /**
+   * \brief Layers this interner over a base interner, as a scoped pool.
+   * \param base The base, or \c nullptr to stand alone again
+   * \details Clears this interner first. Strings already in the base, e.g.
+   * keywords and a standard library frozen at startup, keep the base's
+   * handles and symbols; every other string is copied here and numbered
+   * after the base's symbols. A long-running process can give each
+   * request or compilation its own layer and \ref clear() it afterwards,
+   * reclaiming the transient strings without touching the base.
+   *
+   * Lookups, \ref getString(Symbol) and \ref contains() see both layers;
+   * iteration, \ref size(), snapshots and statistics cover this layer
+   * only.
+   * \warning The base must outlive this interner and must not intern new
+   * strings while layers sit on it, or two layers could give one string
+   * different handles; \ref freeze() it first. Handles of layer strings
+   * compare equal only within their layer.
+   * \throws std::invalid_argument if this interner copies strings into a
+   * caller's arena; \ref clear() could drop the table but not the bytes,
+   * so such a layer would leak. Layers use the default constructor.
+   * \note Call before the interner is shared between threads.
+   */
+  void setBaseLayer(const StringInterner *base);
+
+  /**
+   * \brief Gets the base interner.
+   * \return The base, or \c nullptr if this interner stands alone.
+   */
+  const StringInterner *getBaseLayer() const { return Base; }
+
   /**
    * \class const_iterator
    * \brief Const iterator for iterating over interned strings.
+   * \details Visits strings in the order they were first interned, by
+   * walking the symbol table, so a full pass is linear and two interners
+   * fed the same strings in the same order iterate identically. The empty
+   * string is not visited.
+   * \note Strings interned by other threads during iteration may or may
+   * not be visited.
    */
   class const_iterator {
   public:
@@ -387,10 +670,22 @@ public:
 
   private:
     friend class StringInterner;
-    explicit const_iterator(const StringInterner *interner, size_t index);
+    const_iterator(const StringInterner *interner, uint32_t id);
+
+    /**
+     * \brief Moves to the next recorded symbol at or after the current
+     * one, or to the end.
+     * \details IDs reserved by \ref loadSnapshot() but never used, and
+     * IDs whose string is still being recorded, are skipped.
+     */
+    void settle();
 
     const StringInterner *interner = nullptr;
-    size_t index = 0;
+
+    /**
+     * \brief The current symbol ID; \ref Symbol::kInvalidID at the end.
+     */
+    uint32_t id = Symbol::kInvalidID;
   };
 
   const_iterator begin() const;
@@ -398,85 +693,214 @@ public:
 
 private:
   /**
-   * \struct StringStorage
-   * \brief Internal storage for an interned string.
+   * \brief Finds or creates the storage for a string.
+   * \param str The string to find or create.
+   * \return Pointer to the interned string data.
+   */
+  const char *findOrCreateString(std::string_view str);
+
+  /**
+   * \brief Pointer to the ArenaAllocator used for string storage.
+   * \note nullptr if not using arena allocation.
+   */
+  ArenaAllocator *arenaAllocator;
+
+  /**
+   * \brief Pointer to the ConcurrentArena used for string storage.
+   * \note nullptr if not using concurrent arena allocation.
+   */
+  ConcurrentArena *concurrentArena = nullptr;
+
+  /**
+   * \brief log2 of \ref kShardCount.
+   */
+  static constexpr size_t kShardBits = 6;
+
+  /**
+   * \brief The number of independently locked shards.
+   * \details Strings are assigned to shards by hash, so threads interning
+   * different strings rarely contend for the same lock.
+   */
+  static constexpr size_t kShardCount = size_t{1} << kShardBits;
+
+  /**
+   * \struct Shard
+   * \brief One independently locked partition of the interned strings.
+   * \note Cache-line aligned so that shards do not false-share.
    */
-  struct StringStorage {
+  struct alignas(64) Shard {
     /**
-     * \brief Pointer to the string data.
+     * \brief Guards everything in the shard except \ref lookupCount.
      */
-    char *data;
+    mutable std::shared_mutex Mutex;
 
     /**
-     * \brief Size of the string data (in bytes).
+     * \brief The shard's strings.
      */
-    size_t size;
+    FlatStringTable Table;
 
     /**
-     * \brief Indicates if the string uses arena allocation.
+     * \brief Holds copies of the shard's strings when the interner has no
+     * arena of its own; created on first use.
      */
-    bool usesArena;
+    std::unique_ptr<ArenaAllocator> Strings;
 
-    StringStorage(std::string_view str, ArenaAllocator *arena = nullptr);
-    ~StringStorage();
+    /**
+     * \brief The bytes copied into \ref Strings.
+     */
+    size_t copiedBytes = 0;
 
-    StringStorage(const StringStorage &) = delete;
-    StringStorage &operator=(const StringStorage &) = delete;
-    StringStorage(StringStorage &&other) noexcept;
-    StringStorage &operator=(StringStorage &&other) noexcept;
+    /**
+     * \brief Intern calls routed to this shard.
+     */
+    std::atomic<size_t> lookupCount{0};
 
-    const char *c_str() const { return data; }
+    /**
+     * \brief The shard's counters; \c lookupCount and \c averageLength
+     * are filled in by \ref getStats().
+     */
+    StringInternerStats stats;
   };
 
   /**
-   * \brief Finds or creates the storage for a string.
-   * \param str The string to find or create.
-   * \return Pointer to the interned string data.
+   * \brief Selects the shard for a hash.
+   * \param hash The string's hash
+   * \return The shard owning strings with that hash
+   * \note Uses the high bits; the shard's own map buckets by the low ones.
    */
-  const char *findOrCreateString(std::string_view str);
+  Shard &getShard(size_t hash) const { return Shards[getShardIndex(hash)]; }
 
   /**
-   * \brief Pointer to the ArenaAllocator used for string storage.
-   * \note nullptr if not using arena allocation.
+   * \brief Gets the index of the shard for a hash.
+   * \param hash The string's hash
+   * \return An index below \ref kShardCount
    */
-  ArenaAllocator *arenaAllocator;
+  static size_t getShardIndex(size_t hash) {
+    return hash >> (std::numeric_limits<size_t>::digits - kShardBits);
+  }
 
   /**
-   * \brief Mutex for thread-safe access.
+   * \brief Allocates the shards.
    */
-  mutable std::shared_mutex Mutex;
+  void initShards();
 
   /**
-   * \brief Set of all unique StringStorage instances.
-   * \note Manages the lifetime of interned strings.
+   * \brief Copies a string into the interner's storage.
+   * \param shard The shard the string belongs to, locked exclusively
+   * \param str The string to copy
+   * \param hash The string's content hash
+   * \param id The string's symbol ID, from \ref allocateSymbols()
+   * \return The null-terminated copy, after its \ref InternedStringHeader
+   * \throws std::length_error if the string is 4 GiB or longer.
    */
-  std::unordered_set<std::unique_ptr<StringStorage>> Storage;
+  const char *copyString(Shard &shard, std::string_view str, uint64_t hash,
+                         uint32_t id);
 
   /**
-   * \brief Map from string views to interned string data pointers.
-   * \note Enables fast lookup of interned strings.
+   * \brief Reserves consecutive symbol IDs.
+   * \param count The number of IDs
+   * \return The first ID
+   * \throws std::length_error if the IDs run out.
    */
-  std::unordered_map<std::string_view, const char *> LookupMap;
+  uint32_t allocateSymbols(uint32_t count);
 
   /**
-   * \brief Statistics about the \ref StringInterner.
+   * \brief The shards, \ref kShardCount of them.
    */
-  mutable StringInternerStats stats;
+  std::unique_ptr<Shard[]> Shards;
 
   /**
-   * \brief Hash function for StringStorage
+   * \brief The strings moved out of the shards by \ref freeze(), if any.
+   * \note Immutable between calls to \ref freeze(), so read without locks.
    */
-  struct StringStorageHash {
-    size_t operator()(const std::unique_ptr<StringStorage> &storage) const;
-  };
+  std::unique_ptr<PerfectStringTable> Frozen;
 
   /**
-   * \brief Equality function for StringStorage
+   * \brief The layer below this one, if any; see \ref setBaseLayer().
    */
-  struct StringStorageEqual {
-    bool operator()(const std::unique_ptr<StringStorage> &lhs,
-                    const std::unique_ptr<StringStorage> &rhs) const;
-  };
+  const StringInterner *Base = nullptr;
+
+  /**
+   * \brief The first symbol ID this layer hands out; IDs below it, other
+   * than 0, belong to \ref Base.
+   */
+  uint32_t firstSymbol = 1;
+
+  /**
+   * \brief Finds a string in this layer or the layers below.
+   * \param str The string, not empty
+   * \param hash The string's hash
+   * \return The interned string's bytes, or \c nullptr if not interned
+   */
+  const char *findExisting(std::string_view str, size_t hash) const;
+
+  /**
+   * \brief The number of symbols in the first segment of
+   * \ref SymbolSegments; each later segment doubles.
+   */
+  static constexpr size_t kFirstSegmentSize = 1024;
+
+  /**
+   * \brief Enough segments to hold every 32-bit ID.
+   */
+  static constexpr size_t kSegmentCount = 23;
+
+  /**
+   * \brief Finds where a symbol's string is recorded.
+   * \param id The symbol ID
+   * \return The segment and the index within it
+   */
+  static std::pair<size_t, size_t> getSegmentSlot(uint32_t id);
+
+  /**
+   * \brief Gets the string recorded for a symbol ID.
+   * \param id The symbol ID
+   * \return The interned string's bytes, or \c nullptr if none is
+   * recorded
+   */
+  const char *getSymbolData(uint32_t id) const;
+
+  /**
+   * \brief Records the string of a symbol.
+   * \param id The symbol ID
+   * \param data The interned string's bytes
+   */
+  void setSymbolString(uint32_t id, const char *data);
+
+  /**
+   * \brief Frees the symbol segments.
+   */
+  void clearSymbols();
+
+  /**
+   * \brief Maps symbol IDs to strings.
+   * \details Segments are allocated on demand and never move, so readers
+   * need no lock while the interner grows.
+   */
+  std::atomic<std::atomic<const char *> *> SymbolSegments[kSegmentCount] = {};
+
+  /**
+   * \brief The next symbol ID to hand out.
+   */
+  std::atomic<uint32_t> nextSymbol{1};
+
+  /**
+   * \brief Serializes segment allocation.
+   */
+  std::mutex symbolMutex;
+
+  /**
+   * \brief Serializes allocation from \ref arenaAllocator, which is not
+   * thread-safe; unused with a \ref ConcurrentArena or the heap.
+   */
+  std::mutex arenaMutex;
+
+  /**
+   * \brief The budget interned strings are charged to, if any.
+   */
+  MemoryBudget *budget = nullptr;
+  MemoryBudget::Client *budgetClient = nullptr;
+
 };
 
 /**
@@ -500,4 +924,13 @@ template <> struct hash<ml::InternedString> {
     return str.getHashValue();
   }
 };
-} // namespace std
\ No newline at end of file
+
+/**
+ * \brief Specialization of std::hash for ml::Symbol.
+ */
+template <> struct hash<ml::Symbol> {
+  size_t operator()(const ml::Symbol &symbol) const noexcept {
+    return symbol.getID();
+  }
+};
+} // namespace std
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ml/Basic/MemoryBudget.hpp"
 #include "ml/Basic/SourceLocation.hpp"
 #include "ml/Basic/StringInterner.hpp"
 #include <functional>
@@ -190,6 +191,11 @@ public:
   /// Set the source manager for location information
   void setSourceManager(const SourceManager *srcMgr) { this->srcMgr = srcMgr; }
 
+  /// Report MemoryOverflowError when the budget is exceeded. Pass nullptr to
+  /// stop. The budget must outlive the manager; moving the manager carries
+  /// the budget along.
+  void setMemoryBudget(MemoryBudget *budget);
+
   /// Add a diagnostic consumer
   void addConsumer(std::unique_ptr<DiagnosticConsumer> consumer);
 
@@ -239,6 +245,7 @@ public:
 private:
   StringInterner &interner;
   const SourceManager *srcMgr = nullptr;
+  MemoryBudget *memoryBudget = nullptr;
 
   std::vector<std::unique_ptr<DiagnosticConsumer>> consumers;
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ml/Basic/MemoryBudget.hpp"
 #include "ml/Basic/StringInterner.hpp"
 #include <cstdint>
 #include <memory>
@@ -100,8 +101,13 @@ public:
   /// Remove a specific file from the cache.
   void removeFromCache(const std::string &filename);
 
+  /// Charge cached files to a memory budget, or detach with nullptr. Under
+  /// pressure the budget evicts cached files; a file that still does not fit
+  /// is returned without being cached.
+  void setMemoryBudget(MemoryBudget *budget);
+
   /// Set the maximum cache size in bytes. Files will be evicted when this limit
-  /// is exceeded.
+  /// is exceeded. Prefer a shared MemoryBudget over a per-manager limit.
   void setMaxCacheSize(size_t maxSize) { maxCacheSize = maxSize; }
   size_t getMaxCacheSize() const { return maxCacheSize; }
 
@@ -122,6 +128,10 @@ public:
   size_t getMemoryMappingThreshold() const { return memoryMappingThreshold; }
 
 private:
+  using FileCache = std::unordered_map<InternedString,
+                                       std::shared_ptr<FileEntry>,
+                                       InternedStringHash>;
+
   /// Internal method to load a file from disk.
   std::pair<std::shared_ptr<FileEntry>, std::error_code>
   loadFile(const std::string &filename);
@@ -129,15 +139,23 @@ private:
   /// Evict files from cache if needed to stay under the size limit.
   void evictIfNeeded();
 
+  /// Evict at least the given number of bytes for the memory budget.
+  size_t evictForBudget(size_t bytes);
+
+  /// Remove a cache entry and release its budget charge. Requires cacheMutex.
+  FileCache::iterator eraseFromCache(FileCache::iterator it);
+
   /// Normalize a filename to a canonical form for caching.
   std::string normalizeFilename(const std::string &filename) const;
 
   mutable std::mutex cacheMutex;
-  std::unordered_map<InternedString, std::shared_ptr<FileEntry>,
-                     InternedStringHash>
-      fileCache;
+  FileCache fileCache;
   StringInterner &interner;
 
+  // Memory accounting
+  MemoryBudget *budget = nullptr;
+  MemoryBudget::Client *budgetClient = nullptr;
+
   // Configuration
   size_t maxCacheSize = SIZE_MAX; // No limit by default
   bool memoryMappingEnabled = true;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ml/Basic/MemoryBudget.hpp"
 #include "ml/Basic/SourceLocation.hpp"
 #include "ml/Basic/StringInterner.hpp"
 #include "ml/Managers/FileManager.hpp"
@@ -123,6 +124,9 @@ public:
   /// Clear all cached data (but keep file entries alive through FileManager).
   void clearCache();
 
+  /// Charge cached line tables to a memory budget, or detach with nullptr.
+  void setMemoryBudget(MemoryBudget *budget);
+
 private:
   /// Compute line offsets for a file (cached after first computation).
   void computeLineOffsets(FileID fid) const;
@@ -153,6 +157,10 @@ private:
   // Statistics
   mutable SourceManagerStats stats;
 
+  // Memory accounting
+  MemoryBudget *budget = nullptr;
+  MemoryBudget::Client *budgetClient = nullptr;
+
   // Constants
   static constexpr uint32_t invalidLocationID = 0;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "ml/Basic/InternCache.hpp"
+#include "ml/Basic/LocalStringTable.hpp"
 #include "ml/Basic/SourceLocation.hpp"
 #include "ml/Basic/StringInterner.hpp"
 #include "ml/Managers/DiagnosticManager.hpp"
@@ -30,6 +32,11 @@ struct LexerStats {
   size_t branchMisses = 0;
   double avgTokenLength = 0.0;
 
+  // Identifier and literal text answered by the lexer's own InternCache,
+  // and text that had to go to the shared StringInterner
+  size_t internCacheHits = 0;
+  size_t internCacheMisses = 0;
+
   void updateAverages() {
     if (tokenCount > 0) {
       avgTokenLength = static_cast<double>(characterCount) / tokenCount;
@@ -84,6 +91,18 @@ public:
   /// Tokenize the next token
   Token nextToken();
 
+  /// Tokenize up to \p maxTokens tokens, appending them to \p tokens.
+  /// Identifier and literal text is interned in one batch at the end, so
+  /// the interner is visited once per block rather than once per token.
+  /// Returns the number of tokens added; the last is EndOfFile at the end.
+  size_t nextTokens(std::vector<Token> &tokens, size_t maxTokens);
+
+  /// Number identifier and literal text in \p table instead of interning
+  /// it. Token symbols are then the table's local IDs, to be remapped once
+  /// the table is merged into the interner; lexing takes no locks at all.
+  /// Pass nullptr to intern again.
+  void setLocalTable(LocalStringTable *table) { localTable = table; }
+
   /// Peek at the next token without consuming it
   const Token &peekToken();
 
@@ -134,6 +153,8 @@ private:
   const SourceManager *srcMgr;
   FileID fid;
   StringInterner &interner;
+  InternCache internCache;
+  LocalStringTable *localTable = nullptr;
   DiagnosticManager &diagMgr;
   LexerOptions options;
   PreprocessorCallback ppCallback;
@@ -150,6 +171,11 @@ private:
   mutable std::unique_ptr<Token> peekedToken;
   mutable bool hasPeekedToken = false;
 
+  // Text awaiting interning while nextTokens() fills a block
+  bool deferInterning = false;
+  std::vector<std::string_view> pendingTexts;
+  std::vector<size_t> pendingTokens;
+
   // Statistics
   mutable LexerStats stats; // Helper methods
   char peek(size_t offset = 0) const;
@@ -176,6 +202,7 @@ private:
   Token makeStringToken(const char *start, const char *end);
   Token makeCharToken(const char *start, const char *end);
   Token makeNumberToken(const char *start, const char *end);
+  void internText(Token &token, std::string_view text);
 
   // Specific token lexing
   Token lexIdentifier();
@@ -278,6 +305,9 @@ public:
   /// Print all tokens (for debugging)
   void printTokens(std::ostream &os) const;
 
+  /// Print all tokens with their text, resolved through \p interner
+  void printTokens(std::ostream &os, const StringInterner &interner) const;
+
   /// Get memory usage
   size_t getMemoryUsage() const;
 
@@ -308,7 +338,9 @@ public:
   BatchTokenizer(StringInterner &interner, DiagnosticManager &diagMgr,
                  const LexerOptions &opts = LexerOptions{});
 
-  /// Tokenize multiple sources in parallel (if supported)
+  /// Tokenize multiple sources in parallel. Symbols, diagnostics and
+  /// statistics are merged in source order, so the result is identical to
+  /// tokenizing the sources one after another with tokenizeString().
   std::vector<std::vector<Token>>
   tokenizeParallel(const std::vector<std::string_view> &sources);
 
@@ -324,6 +356,9 @@ private:
   DiagnosticManager &diagMgr;
   LexerOptions options;
   mutable LexerStats aggregateStats;
+
+  /// Add one lexer's statistics to the aggregate
+  void addStats(const LexerStats &stats);
 };
 
 } // namespace ml
\ No newline at end of file
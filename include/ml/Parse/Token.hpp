@@ -153,24 +153,25 @@ public:
   Token(TokenKind kind, SourceLocation loc, uint32_t length)
       : kind(kind), flags(TokenFlags::None), location(loc), length(length) {}
 
-  Token(TokenKind kind, SourceLocation loc, uint32_t length,
-        InternedString text)
+  Token(TokenKind kind, SourceLocation loc, uint32_t length, Symbol symbol)
       : kind(kind), flags(TokenFlags::None), location(loc), length(length),
-        value(text) {}
+        symbol(symbol) {}
 
   // Getters
   TokenKind getKind() const { return kind; }
   SourceLocation getLocation() const { return location; }
   uint32_t getLength() const { return length; }
   TokenFlags getFlags() const { return flags; }
-  InternedString getText() const { return value; }
+  /// The interned text of identifiers and literals; resolve it with
+  /// StringInterner::getString()
+  Symbol getSymbol() const { return symbol; }
 
   // Setters
   void setKind(TokenKind kind) { this->kind = kind; }
   void setLocation(SourceLocation loc) { location = loc; }
   void setLength(uint32_t length) { this->length = length; }
   void setFlags(TokenFlags flags) { this->flags = flags; }
-  void setText(InternedString text) { value = text; }
+  void setSymbol(Symbol symbol) { this->symbol = symbol; }
 
   // Flag operations
   bool hasFlag(TokenFlags flag) const {
@@ -241,7 +242,7 @@ private:
   TokenFlags flags;
   SourceLocation location;
   uint32_t length;
-  InternedString value; // For identifiers, literals, etc.
+  Symbol symbol; // For identifiers, literals, etc.
 };
 
 /// Token information and utilities
@@ -282,4 +283,9 @@ public:
 std::ostream &operator<<(std::ostream &os, TokenKind kind);
 std::ostream &operator<<(std::ostream &os, const Token &token);
 
+/// Print a token with its text, resolved through the interner that
+/// numbered its symbol; operator<< can only show the symbol ID
+void printToken(std::ostream &os, const Token &token,
+                const StringInterner &interner);
+
 } // namespace ml
\ No newline at end of file
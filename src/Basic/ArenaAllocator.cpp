@@ -4,9 +4,86 @@
 #include <iomanip>
 #include <iostream>
 
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#endif
+
+// Reserves an address range without committing any memory.
+static char *reserveVirtualMemory(size_t size) {
+#ifdef _WIN32
+  return static_cast<char *>(
+      VirtualAlloc(nullptr, size, MEM_RESERVE, PAGE_NOACCESS));
+#else
+  // Over-reserve so the range can be aligned for transparent huge pages
+  size_t alignment = ml::ArenaAllocator::kCommitGranularity;
+  void *base = mmap(nullptr, size + alignment, PROT_NONE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (base == MAP_FAILED) {
+    return nullptr;
+  }
+
+  // Trim the unaligned head and the unused tail
+  uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+  uintptr_t aligned = (addr + alignment - 1) & ~(alignment - 1);
+  size_t head = aligned - addr;
+  if (head > 0) {
+    munmap(base, head);
+  }
+  munmap(reinterpret_cast<char *>(aligned) + size, alignment - head);
+
+  char *ptr = reinterpret_cast<char *>(aligned);
+#ifdef MADV_HUGEPAGE
+  madvise(ptr, size, MADV_HUGEPAGE);
+#endif
+  return ptr;
+#endif
+}
+
+// Makes a reserved range readable and writable.
+static bool commitVirtualMemory(char *ptr, size_t size) {
+#ifdef _WIN32
+  return VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+  return mprotect(ptr, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+}
+
+// Returns committed pages to the system while keeping the reservation.
+static void decommitVirtualMemory(char *ptr, size_t size) {
+#ifdef _WIN32
+  VirtualFree(ptr, size, MEM_DECOMMIT);
+#else
+  madvise(ptr, size, MADV_DONTNEED);
+  mprotect(ptr, size, PROT_NONE);
+#endif
+}
+
+// Releases an entire reservation.
+static void releaseVirtualMemory(char *ptr, size_t size) {
+#ifdef _WIN32
+  (void)size;
+  VirtualFree(ptr, 0, MEM_RELEASE);
+#else
+  munmap(ptr, size);
+#endif
+}
+
 namespace ml {
 
-ArenaAllocator::ArenaAllocator(size_t chunkSize) : chunkSize(chunkSize) {
+void ArenaChunkDeleter::operator()(char *ptr) const {
+  if (reservedSize != 0) {
+    releaseVirtualMemory(ptr, reservedSize);
+  } else {
+    delete[] ptr;
+  }
+}
+
+template <typename StatsPolicy>
+BasicArenaAllocator<StatsPolicy>::BasicArenaAllocator(size_t chunkSize,
+                                                      ArenaBackend backend)
+    : chunkSize(chunkSize), backend(backend) {
   // Ensure minimum chunk size
   if (this->chunkSize < 1024) {
     this->chunkSize = 1024;
@@ -16,30 +93,62 @@ ArenaAllocator::ArenaAllocator(size_t chunkSize) : chunkSize(chunkSize) {
   allocateNewChunk();
 }
 
-ArenaAllocator::~ArenaAllocator() {
-  // Chunks will be automatically destroyed
+template <typename StatsPolicy>
+BasicArenaAllocator<StatsPolicy>::~BasicArenaAllocator() {
+  // Destroy tracked objects; chunks will be automatically destroyed
+  runCleanups();
+  setMemoryBudget(nullptr);
 }
 
-ArenaAllocator::ArenaAllocator(ArenaAllocator &&other) noexcept
-    : Chunks(std::move(other.Chunks)), chunkSize(other.chunkSize),
-      stats(other.stats) {
+template <typename StatsPolicy>
+BasicArenaAllocator<StatsPolicy>::BasicArenaAllocator(
+    BasicArenaAllocator &&other) noexcept
+    : Chunks(std::move(other.Chunks)), currentChunk(other.currentChunk),
+      cleanups(other.cleanups), chunkSize(other.chunkSize),
+      maxRetainedBytes(other.maxRetainedBytes), backend(other.backend),
+      statsPolicy(std::move(other.statsPolicy)), budget(other.budget),
+      budgetClient(other.budgetClient), budgetedBytes(other.budgetedBytes) {
   // Reset the moved-from object
-  other.stats = ArenaStats{};
+  other.currentChunk = 0;
+  other.cleanups = nullptr;
+  other.statsPolicy.onReset();
+  other.budget = nullptr;
+  other.budgetClient = nullptr;
+  other.budgetedBytes = 0;
 }
 
-ArenaAllocator &ArenaAllocator::operator=(ArenaAllocator &&other) noexcept {
+template <typename StatsPolicy>
+BasicArenaAllocator<StatsPolicy> &
+BasicArenaAllocator<StatsPolicy>::operator=(
+    BasicArenaAllocator &&other) noexcept {
   if (this != &other) {
+    runCleanups();
+    setMemoryBudget(nullptr);
     Chunks = std::move(other.Chunks);
+    currentChunk = other.currentChunk;
+    cleanups = other.cleanups;
     chunkSize = other.chunkSize;
-    stats = other.stats;
+    maxRetainedBytes = other.maxRetainedBytes;
+    backend = other.backend;
+    statsPolicy = std::move(other.statsPolicy);
+    budget = other.budget;
+    budgetClient = other.budgetClient;
+    budgetedBytes = other.budgetedBytes;
 
     // Reset the moved-from object
-    other.stats = ArenaStats{};
+    other.currentChunk = 0;
+    other.cleanups = nullptr;
+    other.statsPolicy.onReset();
+    other.budget = nullptr;
+    other.budgetClient = nullptr;
+    other.budgetedBytes = 0;
   }
   return *this;
 }
 
-void *ArenaAllocator::allocate(size_t size, size_t alignment) {
+template <typename StatsPolicy>
+void *BasicArenaAllocator<StatsPolicy>::allocateSlow(size_t size,
+                                                     size_t alignment) {
   if (size == 0) {
     return nullptr;
   }
@@ -55,37 +164,119 @@ void *ArenaAllocator::allocate(size_t size, size_t alignment) {
     alignment = kDefaultAlignment;
   }
 
-  // Try to allocate from the current (last) chunk
-  if (!Chunks.empty()) {
-    size_t oldUsed = Chunks.back().used;
-    void *ptr = Chunks.back().allocate(size, alignment);
-    if (ptr) {
-      size_t actualAllocated = Chunks.back().used - oldUsed;
-      updateStats(size, actualAllocated);
-      return ptr;
-    }
+  // Try to allocate from the current chunk
+  if (void *ptr = allocateFromCurrentChunk(size, alignment)) {
+    return ptr;
   }
 
-  // Need a new chunk
+  // Commit more of the current reservation before moving on
   size_t neededSize = size + alignment - 1; // Worst case alignment padding
-  allocateNewChunk(std::max(neededSize, chunkSize));
+  if (commitCurrentChunk(neededSize)) {
+    return allocateFromCurrentChunk(size, alignment);
+  }
 
-  // Try again with the new chunk
+  // Need a new chunk
+  advanceChunk(neededSize);
   assert(!Chunks.empty());
-  size_t oldUsed = Chunks.back().used;
-  void *ptr = Chunks.back().allocate(size, alignment);
-
-  if (ptr) {
-    size_t actualAllocated = Chunks.back().used - oldUsed;
-    updateStats(size, actualAllocated);
+  if (void *ptr = allocateFromCurrentChunk(size, alignment)) {
     return ptr;
   }
 
-  // This should never happen if our math is correct
+  // A fresh virtual chunk has nothing committed yet
+  if (commitCurrentChunk(neededSize)) {
+    return allocateFromCurrentChunk(size, alignment);
+  }
+
   return nullptr;
 }
 
-char *ArenaAllocator::allocateString(const char *str, size_t length) {
+template <typename StatsPolicy>
+bool BasicArenaAllocator<StatsPolicy>::resize(void *ptr, size_t oldSize,
+                                              size_t newSize) {
+  if (!ptr || Chunks.empty() || newSize > kMaxAllocationSize) {
+    return false;
+  }
+
+  // Only the allocation ending at the bump pointer can change size
+  ArenaChunk &chunk = Chunks[currentChunk];
+  uintptr_t begin = reinterpret_cast<uintptr_t>(chunk.memory.get());
+  uintptr_t addr = reinterpret_cast<uintptr_t>(ptr);
+  if (addr < begin || addr + oldSize != begin + chunk.used) {
+    return false;
+  }
+
+  if (newSize > oldSize) {
+    size_t growth = newSize - oldSize;
+    if (!chunk.canFit(growth) && !commitCurrentChunk(growth)) {
+      return false;
+    }
+
+    chunk.used += growth;
+    statsPolicy.onGrow(growth);
+    return true;
+  }
+
+  // Memory still referenced by a pending destructor must stay alive
+  if (cleanups && cleanups->object == ptr) {
+    return false;
+  }
+
+  size_t shrink = oldSize - newSize;
+  chunk.used -= shrink;
+  statsPolicy.onRelease(shrink);
+  return true;
+}
+
+template <typename StatsPolicy>
+void *BasicArenaAllocator<StatsPolicy>::allocateFromCurrentChunk(
+    size_t size, size_t alignment) {
+  if (Chunks.empty()) {
+    return nullptr;
+  }
+
+  ArenaChunk &chunk = Chunks[currentChunk];
+  size_t oldUsed = chunk.used;
+  void *ptr = chunk.allocate(size, alignment);
+  if (ptr) {
+    statsPolicy.onAllocate(size, chunk.used - oldUsed);
+  }
+  return ptr;
+}
+
+template <typename StatsPolicy>
+bool BasicArenaAllocator<StatsPolicy>::commitCurrentChunk(size_t minSize) {
+  if (Chunks.empty()) {
+    return false;
+  }
+
+  ArenaChunk &chunk = Chunks[currentChunk];
+  if (!chunk.isVirtual() || chunk.used + minSize > chunk.reserved) {
+    return false;
+  }
+
+  if (chunk.canFit(minSize)) {
+    return true;
+  }
+
+  // Commit whole granules so that huge pages can back the range
+  size_t required = chunk.used + minSize;
+  size_t newSize = (required + kCommitGranularity - 1) &
+                   ~(kCommitGranularity - 1);
+  newSize = std::min(newSize, chunk.reserved);
+
+  if (!commitVirtualMemory(chunk.memory.get() + chunk.size,
+                           newSize - chunk.size)) {
+    return false;
+  }
+
+  chunk.size = newSize;
+  syncBudget();
+  return true;
+}
+
+template <typename StatsPolicy>
+char *BasicArenaAllocator<StatsPolicy>::allocateString(const char *str,
+                                                       size_t length) {
   if (!str) {
     return nullptr;
   }
@@ -100,40 +291,112 @@ char *ArenaAllocator::allocateString(const char *str, size_t length) {
   return result;
 }
 
-void ArenaAllocator::reset() {
-  Chunks.clear();
-  stats = ArenaStats{};
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::rewind(const ArenaMarker &marker) {
+  if (Chunks.empty()) {
+    return;
+  }
 
-  // Allocate a fresh initial chunk
-  allocateNewChunk();
+  // Destroy objects constructed after the marker before releasing them
+  runCleanups(marker.cleanups);
+
+  assert(marker.chunkIndex <= currentChunk && "Marker is ahead of the arena");
+
+  // An allocation older than the marker may have been freed or shrunk
+  // since, leaving the marker's chunk below it; nothing is released there
+  // then, and the chunk stays where it is
+  ArenaChunk &markerChunk = Chunks[marker.chunkIndex];
+  size_t released =
+      markerChunk.used > marker.used ? markerChunk.used - marker.used : 0;
+
+  // Release everything in the chunks after the marker; they stay allocated
+  // and are reset when allocation reaches them again
+  for (size_t i = marker.chunkIndex + 1; i <= currentChunk; ++i) {
+    released += Chunks[i].used;
+  }
+
+  markerChunk.used = std::min(markerChunk.used, marker.used);
+  currentChunk = marker.chunkIndex;
+  statsPolicy.onRelease(released);
 }
 
-void ArenaAllocator::clear() {
-  // Reset all chunks to unused state
-  for (auto &chunk : Chunks) {
-    chunk.used = 0;
+template <typename StatsPolicy> void BasicArenaAllocator<StatsPolicy>::reset() {
+  clear();
+
+  // Return chunks beyond the retention limit to the system
+  size_t retained = 0;
+  size_t keep = 0;
+  while (keep < Chunks.size() &&
+         (keep == 0 || retained + Chunks[keep].size <= maxRetainedBytes)) {
+    retained += Chunks[keep].size;
+    ++keep;
+  }
+
+  if (keep < Chunks.size()) {
+    Chunks.erase(Chunks.begin() + static_cast<std::ptrdiff_t>(keep),
+                 Chunks.end());
   }
 
-  // Reset usage stats but keep allocation stats
-  stats.currentUsage = 0;
-  stats.allocationCount = 0;
+  // A single virtual chunk may exceed the limit on its own; decommit its
+  // pages beyond the limit instead of releasing the reservation
+  if (keep == 1 && Chunks.front().isVirtual() && retained > maxRetainedBytes) {
+    ArenaChunk &chunk = Chunks.front();
+    size_t newSize = (maxRetainedBytes + kCommitGranularity - 1) &
+                     ~(kCommitGranularity - 1);
+    decommitVirtualMemory(chunk.memory.get() + newSize, chunk.size - newSize);
+    chunk.size = newSize;
+  }
+
+  statsPolicy.onReset();
+
+  // Always keep an initial chunk to allocate from
+  if (Chunks.empty()) {
+    allocateNewChunk();
+  }
+  syncBudget();
 }
 
-ArenaStats ArenaAllocator::getStats() const {
-  // Update current usage
-  stats.currentUsage = 0;
-  for (const auto &chunk : Chunks) {
-    stats.currentUsage += chunk.used;
+template <typename StatsPolicy> void BasicArenaAllocator<StatsPolicy>::clear() {
+  runCleanups();
+
+  // Rewind to the first chunk; later chunks are reset as they are reused
+  currentChunk = 0;
+  if (!Chunks.empty()) {
+    Chunks.front().used = 0;
+  }
+
+  // Reset usage stats but keep peak and chunk stats
+  statsPolicy.onClear();
+}
+
+template <typename StatsPolicy>
+ArenaStats BasicArenaAllocator<StatsPolicy>::getStats() const {
+  // Everything except the policy's counters is derived from the chunks
+  ArenaStats stats;
+  stats.chunkCount = Chunks.size();
+  stats.allocatedCount = getTotalAllocated();
+  stats.currentUsage = getTotalUsed();
+
+  // Split chunk capacity into active and retained bytes
+  for (size_t i = 0; i < getActiveChunkCount(); ++i) {
+    stats.activeByteCount += Chunks[i].size;
   }
+  stats.retainedByteCount = stats.allocatedCount - stats.activeByteCount;
 
-  stats.peakUsage = std::max(stats.peakUsage, stats.currentUsage);
+  for (ArenaCleanup *cleanup = cleanups; cleanup; cleanup = cleanup->next) {
+    ++stats.pendingDestructorCount;
+  }
+
+  statsPolicy.fill(stats);
   return stats;
 }
 
-bool ArenaAllocator::contains(const void *ptr) const {
+template <typename StatsPolicy>
+bool BasicArenaAllocator<StatsPolicy>::contains(const void *ptr) const {
   const char *charPtr = static_cast<const char *>(ptr);
 
-  for (const auto &chunk : Chunks) {
+  for (size_t i = 0; i < getActiveChunkCount(); ++i) {
+    const auto &chunk = Chunks[i];
     const char *start = chunk.memory.get();
     const char *end = start + chunk.used;
 
@@ -145,7 +408,8 @@ bool ArenaAllocator::contains(const void *ptr) const {
   return false;
 }
 
-size_t ArenaAllocator::getTotalAllocated() const {
+template <typename StatsPolicy>
+size_t BasicArenaAllocator<StatsPolicy>::getTotalAllocated() const {
   size_t total = 0;
   for (const auto &chunk : Chunks) {
     total += chunk.size;
@@ -153,65 +417,177 @@ size_t ArenaAllocator::getTotalAllocated() const {
   return total;
 }
 
-size_t ArenaAllocator::getTotalUsed() const {
+template <typename StatsPolicy>
+size_t BasicArenaAllocator<StatsPolicy>::getTotalUsed() const {
   size_t total = 0;
-  for (const auto &chunk : Chunks) {
-    total += chunk.used;
+  for (size_t i = 0; i < getActiveChunkCount(); ++i) {
+    total += Chunks[i].used;
   }
   return total;
 }
 
-void ArenaAllocator::printStats(std::ostream &OS) const {
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::printStats(std::ostream &OS) const {
   auto stats = getStats();
 
   OS << "Arena Allocator Statistics:\n";
   OS << "  Total allocated: " << stats.allocatedCount << " bytes\n";
-  OS << "  Total requested: " << stats.requestedCount << " bytes\n";
+  if constexpr (StatsPolicy::kCountsAllocations) {
+    OS << "  Total requested: " << stats.requestedCount << " bytes\n";
+  }
   OS << "  Current usage: " << stats.currentUsage << " bytes\n";
-  OS << "  Peak usage: " << stats.peakUsage << " bytes\n";
-  OS << "  Number of allocations: " << stats.allocationCount << "\n";
+  if constexpr (StatsPolicy::kCountsAllocations) {
+    OS << "  Peak usage: " << stats.peakUsage << " bytes\n";
+    OS << "  Number of allocations: " << stats.allocationCount << "\n";
+  }
   OS << "  Number of chunks: " << stats.chunkCount << "\n";
-  OS << "  Wasted bytes: " << stats.wastedByteCount << " bytes\n";
-  OS << "  Fragmentation ratio: " << std::fixed << std::setprecision(2)
-     << (stats.getFragmentationRatio() * 100.0) << "%\n";
-  OS << "  Efficiency: " << std::fixed << std::setprecision(2)
-     << (stats.getEfficiency() * 100.0) << "%\n";
+  OS << "  Active chunk bytes: " << stats.activeByteCount << " bytes\n";
+  OS << "  Retained chunk bytes: " << stats.retainedByteCount << " bytes\n";
+  OS << "  Pending destructors: " << stats.pendingDestructorCount << "\n";
+  if constexpr (StatsPolicy::kCountsAllocations) {
+    OS << "  Wasted bytes: " << stats.wastedByteCount << " bytes\n";
+    OS << "  Fragmentation ratio: " << std::fixed << std::setprecision(2)
+       << (stats.getFragmentationRatio() * 100.0) << "%\n";
+    OS << "  Efficiency: " << std::fixed << std::setprecision(2)
+       << (stats.getEfficiency() * 100.0) << "%\n";
+  } else {
+    OS << "  Allocation counters: disabled\n";
+  }
 
   OS << "\nChunk details:\n";
   for (size_t i = 0; i < Chunks.size(); ++i) {
     const auto &chunk = Chunks[i];
+    if (i >= getActiveChunkCount()) {
+      OS << "  Chunk " << i << ": 0/" << chunk.size << " bytes (retained)\n";
+      continue;
+    }
+
     double utilization =
         chunk.size > 0 ? (static_cast<double>(chunk.used) / chunk.size) * 100.0
                        : 0.0;
 
     OS << "  Chunk " << i << ": " << chunk.used << "/" << chunk.size
        << " bytes (" << std::fixed << std::setprecision(1) << utilization
-       << "% used)\n";
+       << "% used";
+    if (chunk.isVirtual()) {
+      OS << ", " << chunk.reserved << " bytes reserved";
+    }
+    OS << ")\n";
+  }
+
+  statsPolicy.print(OS);
+}
+
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::advanceChunk(size_t minSize) {
+  // Reuse the next retained chunk if the request fits in it
+  size_t next = getActiveChunkCount();
+  if (next < Chunks.size() && Chunks[next].getCapacity() >= minSize) {
+    Chunks[next].used = 0;
+    currentChunk = next;
+    return;
   }
+
+  allocateNewChunk(minSize);
 }
 
-void ArenaAllocator::allocateNewChunk(size_t minSize) {
-  size_t newChunkSize = std::max(minSize, this->chunkSize);
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::allocateNewChunk(size_t minSize) {
+  size_t index = getActiveChunkCount();
+
+  // Reserve address space only; pages are committed on demand
+  if (backend == ArenaBackend::VirtualMemory) {
+    size_t reserveSize =
+        std::max({minSize, this->chunkSize, kDefaultReserveSize});
+    reserveSize =
+        (reserveSize + kCommitGranularity - 1) & ~(kCommitGranularity - 1);
+
+    if (char *reservation = reserveVirtualMemory(reserveSize)) {
+      Chunks.emplace(Chunks.begin() + static_cast<std::ptrdiff_t>(index),
+                     reservation, reserveSize);
+      currentChunk = index;
+      syncBudget();
+      return;
+    }
 
-  // Ensure chunk size is reasonable
-  if (newChunkSize > 100 * 1024 * 1024) { // 100MB limit
-    newChunkSize = 100 * 1024 * 1024;
+    // Fall back to heap chunks if the reservation fails
   }
 
-  Chunks.emplace_back(newChunkSize);
+  // The cap bounds the preferred size only; a request is never truncated
+  size_t newChunkSize =
+      std::max(minSize, std::min(this->chunkSize, kMaxChunkSize));
 
-  // Update stats
-  ++stats.chunkCount;
-  stats.allocatedCount += newChunkSize;
+  // Insert after the active chunks so retained chunks stay reusable
+  Chunks.emplace(Chunks.begin() + static_cast<std::ptrdiff_t>(index),
+                 newChunkSize);
+  currentChunk = index;
+  syncBudget();
 }
 
-void ArenaAllocator::updateStats(size_t requested, size_t allocated) const {
-  ++stats.allocationCount;
-  stats.requestedCount += requested;
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::setMemoryBudget(MemoryBudget *newBudget,
+                                                       std::string name) {
+  if (budget) {
+    budget->unregisterClient(budgetClient);
+  }
+
+  budget = newBudget;
+  budgetClient = budget ? budget->registerClient(std::move(name)) : nullptr;
+  budgetedBytes = 0;
+  syncBudget();
+}
 
-  if (allocated > requested) {
-    stats.wastedByteCount += (allocated - requested);
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::syncBudget() {
+  if (!budget) {
+    return;
   }
+
+  // Chunk memory is charged, not individual allocations
+  size_t total = getTotalAllocated();
+  if (total > budgetedBytes) {
+    budget->charge(budgetClient, total - budgetedBytes);
+  } else if (total < budgetedBytes) {
+    budget->release(budgetClient, budgetedBytes - total);
+  }
+  budgetedBytes = total;
 }
 
-} // namespace ml
\ No newline at end of file
+template <typename StatsPolicy>
+void BasicArenaAllocator<StatsPolicy>::runCleanups(ArenaCleanup *until) {
+  while (cleanups && cleanups != until) {
+    ArenaCleanup *cleanup = cleanups;
+    cleanups = cleanup->next;
+    cleanup->destroy(cleanup->object);
+  }
+}
+
+void ArenaTracingStats::print(std::ostream &OS) const {
+  OS << "\nAllocation size histogram:\n";
+  for (size_t i = 0; i < kBucketCount; ++i) {
+    if (sizeHistogram[i] > 0) {
+      OS << "  <= " << (size_t{1} << i) << " bytes: " << sizeHistogram[i]
+         << "\n";
+    }
+  }
+
+  size_t counts[5] = {};
+  for (const ArenaTraceEvent &event : Events) {
+    ++counts[static_cast<size_t>(event.kind)];
+  }
+
+  OS << "\nTrace events:\n";
+  OS << "  Allocations: " << counts[0] << "\n";
+  OS << "  In-place growths: " << counts[1] << "\n";
+  OS << "  Releases: " << counts[2] << "\n";
+  OS << "  Clears: " << counts[3] << "\n";
+  OS << "  Resets: " << counts[4] << "\n";
+  OS << "  Dropped: " << droppedEventCount << "\n";
+}
+
+template class BasicArenaAllocator<ArenaNoStats>;
+template class BasicArenaAllocator<ArenaCountingStats>;
+template class BasicArenaAllocator<ArenaTracingStats>;
+template class BasicArenaAllocator<ArenaProfilingStats>;
+
+} // namespace ml
@@ -0,0 +1,147 @@
+#include "ml/Basic/ArenaProfiler.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace ml {
+
+const char *getArenaCategoryName(ArenaCategory category) {
+  switch (category) {
+  case ArenaCategory::Untagged:
+    return "untagged";
+  case ArenaCategory::Interner:
+    return "interner";
+  case ArenaCategory::Lexer:
+    return "lexer";
+  case ArenaCategory::Diagnostics:
+    return "diagnostics";
+  case ArenaCategory::FileCache:
+    return "file_cache";
+  }
+  return "unknown";
+}
+
+std::string ArenaProfileScope::formatTag(uint64_t tag) {
+  if (tag == 0) {
+    return getArenaCategoryName(ArenaCategory::Untagged);
+  }
+
+  // Categories were shifted in from the low end, so read from the top
+  std::string result;
+  for (size_t level = kMaxDepth; level > 0; --level) {
+    uint64_t nibble = (tag >> (4 * (level - 1))) & 0xF;
+    auto category = static_cast<ArenaCategory>(nibble);
+    if (category == ArenaCategory::Untagged) {
+      continue;
+    }
+    if (!result.empty()) {
+      result += ';';
+    }
+    result += getArenaCategoryName(category);
+  }
+  return result;
+}
+
+void ArenaProfilingStats::onAllocate(size_t requested, size_t allocated) {
+  ArenaCountingStats::onAllocate(requested, allocated);
+
+  uint64_t tag = ArenaProfileScope::getCurrentTag();
+  ++charge(tag, allocated).allocationCount;
+
+  if (!LiveRanges.empty() && LiveRanges.back().tag == tag) {
+    LiveRanges.back().byteCount += allocated;
+  } else {
+    LiveRanges.push_back(TaggedRange{tag, allocated});
+  }
+}
+
+void ArenaProfilingStats::onGrow(size_t bytes) {
+  ArenaCountingStats::onGrow(bytes);
+
+  // Only the most recent allocation can grow, so it owns the top range
+  if (LiveRanges.empty()) {
+    LiveRanges.push_back(TaggedRange{ArenaProfileScope::getCurrentTag(), 0});
+  }
+  LiveRanges.back().byteCount += bytes;
+  charge(LiveRanges.back().tag, bytes);
+}
+
+void ArenaProfilingStats::onRelease(size_t bytes) {
+  ArenaCountingStats::onRelease(bytes);
+
+  // Releases are LIFO; charge them to the newest ranges
+  while (bytes > 0 && !LiveRanges.empty()) {
+    TaggedRange &range = LiveRanges.back();
+    size_t released = std::min(range.byteCount, bytes);
+    Profile[range.tag].liveByteCount -= released;
+    range.byteCount -= released;
+    bytes -= released;
+    if (range.byteCount == 0) {
+      LiveRanges.pop_back();
+    }
+  }
+}
+
+void ArenaProfilingStats::onClear() {
+  ArenaCountingStats::onClear();
+
+  // Totals and peaks survive a clear; live bytes do not
+  for (auto &[tag, entry] : Profile) {
+    entry.liveByteCount = 0;
+  }
+  LiveRanges.clear();
+}
+
+ArenaProfileEntry &ArenaProfilingStats::charge(uint64_t tag, size_t bytes) {
+  ArenaProfileEntry &entry = Profile[tag];
+  entry.byteCount += bytes;
+  entry.liveByteCount += bytes;
+  entry.peakByteCount = std::max(entry.peakByteCount, entry.liveByteCount);
+  return entry;
+}
+
+ArenaProfileEntry ArenaProfilingStats::getEntry(uint64_t tag) const {
+  auto it = Profile.find(tag);
+  return it != Profile.end() ? it->second : ArenaProfileEntry{};
+}
+
+void ArenaProfilingStats::print(std::ostream &OS) const {
+  std::vector<std::pair<uint64_t, ArenaProfileEntry>> entries(Profile.begin(),
+                                                              Profile.end());
+  std::sort(entries.begin(), entries.end(), [](const auto &a, const auto &b) {
+    return a.second.byteCount > b.second.byteCount;
+  });
+
+  OS << "\nAllocation profile:\n";
+  for (const auto &[tag, entry] : entries) {
+    OS << "  " << std::left << std::setw(32)
+       << ArenaProfileScope::formatTag(tag) << std::right << " "
+       << entry.byteCount << " bytes in " << entry.allocationCount
+       << " allocations (live " << entry.liveByteCount << ", peak "
+       << entry.peakByteCount << ")\n";
+  }
+}
+
+void ArenaProfilingStats::writeFoldedStacks(std::ostream &OS,
+                                            ArenaProfileMetric metric) const {
+  for (const auto &[tag, entry] : Profile) {
+    size_t value = 0;
+    switch (metric) {
+    case ArenaProfileMetric::Bytes:
+      value = entry.byteCount;
+      break;
+    case ArenaProfileMetric::Allocations:
+      value = entry.allocationCount;
+      break;
+    case ArenaProfileMetric::PeakBytes:
+      value = entry.peakByteCount;
+      break;
+    }
+
+    if (value > 0) {
+      OS << ArenaProfileScope::formatTag(tag) << " " << value << "\n";
+    }
+  }
+}
+
+} // namespace ml
@@ -0,0 +1,212 @@
+#include "ml/Basic/ArenaSnapshot.hpp"
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ml {
+
+static std::error_code getLastSystemError() {
+#ifdef _WIN32
+  return std::error_code(static_cast<int>(GetLastError()),
+                         std::system_category());
+#else
+  return std::error_code(errno, std::generic_category());
+#endif
+}
+
+static std::error_code writeFile(const std::string &path, const char *data,
+                                 size_t size) {
+#ifdef _WIN32
+  int fd = _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY,
+                 _S_IREAD | _S_IWRITE);
+#else
+  int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+#endif
+  if (fd < 0) {
+    return std::error_code(errno, std::generic_category());
+  }
+
+  // One call writes the whole image; loop only on short writes
+  std::error_code error;
+  while (size > 0) {
+#ifdef _WIN32
+    unsigned int request = static_cast<unsigned int>(
+        std::min<size_t>(size, 1u << 30));
+    int written = _write(fd, data, request);
+#else
+    ssize_t written = ::write(fd, data, size);
+#endif
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      error = std::error_code(errno, std::generic_category());
+      break;
+    }
+    data += written;
+    size -= static_cast<size_t>(written);
+  }
+
+#ifdef _WIN32
+  _close(fd);
+#else
+  ::close(fd);
+#endif
+  return error;
+}
+
+ArenaSnapshotWriter::ArenaSnapshotWriter()
+    : arena(BasicArenaAllocator<ArenaNoStats>::kDefaultChunkSize,
+            ArenaBackend::VirtualMemory),
+      header(arena.allocate<ArenaSnapshotHeader>()) {
+  // Offsets in the image are relative to the chunk start
+  assert(getSize() == sizeof(ArenaSnapshotHeader) &&
+         "Snapshot header must open the chunk");
+}
+
+void *ArenaSnapshotWriter::allocate(size_t size, size_t alignment) {
+  void *data = arena.allocate(size, alignment);
+  if (!data) {
+    throw std::bad_alloc();
+  }
+  return data;
+}
+
+SnapshotString ArenaSnapshotWriter::createString(std::string_view str) {
+  char *data = arena.allocateString(str.data(), str.size());
+  if (!data) {
+    throw std::bad_alloc();
+  }
+
+  SnapshotString result;
+  result.Data = data;
+  result.size = str.size();
+  return result;
+}
+
+std::error_code ArenaSnapshotWriter::write(const std::string &path) const {
+  // Heap chunks are used when no reservation could be made; an image that
+  // outgrew the first of them is not contiguous
+  if (arena.getStats().chunkCount != 1) {
+    return std::make_error_code(std::errc::value_too_large);
+  }
+
+  header->size = getSize();
+
+  std::string tempPath = path + ".tmp";
+  if (std::error_code error = writeFile(
+          tempPath, reinterpret_cast<const char *>(header), header->size)) {
+    return error;
+  }
+
+  std::error_code error;
+  std::filesystem::rename(tempPath, path, error);
+  if (error) {
+    std::filesystem::remove(tempPath, error);
+    return std::make_error_code(std::errc::io_error);
+  }
+  return {};
+}
+
+ArenaSnapshot::~ArenaSnapshot() {
+#ifdef _WIN32
+  UnmapViewOfFile(data);
+#else
+  munmap(const_cast<char *>(data), size);
+#endif
+}
+
+std::pair<std::unique_ptr<ArenaSnapshot>, std::error_code>
+ArenaSnapshot::open(const std::string &path) {
+  const char *data = nullptr;
+  size_t size = 0;
+
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ,
+                            nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return {nullptr, getLastSystemError()};
+  }
+
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    std::error_code error = getLastSystemError();
+    CloseHandle(file);
+    return {nullptr, error};
+  }
+  size = static_cast<size_t>(fileSize.QuadPart);
+
+  if (size >= sizeof(ArenaSnapshotHeader)) {
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping) {
+      data = static_cast<const char *>(
+          MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+      CloseHandle(mapping);
+    }
+    if (!data) {
+      std::error_code error = getLastSystemError();
+      CloseHandle(file);
+      return {nullptr, error};
+    }
+  }
+  CloseHandle(file);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return {nullptr, getLastSystemError()};
+  }
+
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    std::error_code error = getLastSystemError();
+    ::close(fd);
+    return {nullptr, error};
+  }
+  size = static_cast<size_t>(fileStat.st_size);
+
+  if (size >= sizeof(ArenaSnapshotHeader)) {
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      std::error_code error = getLastSystemError();
+      ::close(fd);
+      return {nullptr, error};
+    }
+    data = static_cast<const char *>(mapping);
+  }
+  ::close(fd);
+#endif
+
+  if (!data) {
+    return {nullptr, std::make_error_code(std::errc::invalid_argument)};
+  }
+
+  // The mapping is owned from here on, so failures below unmap it
+  std::unique_ptr<ArenaSnapshot> snapshot(new ArenaSnapshot(data, size));
+
+  const ArenaSnapshotHeader &header = snapshot->getHeader();
+  const void *root = header.root.get();
+  if (header.magic != ArenaSnapshotHeader::kMagic ||
+      header.version != ArenaSnapshotHeader::kVersion ||
+      header.size != size || (root && !snapshot->contains(root))) {
+    return {nullptr, std::make_error_code(std::errc::invalid_argument)};
+  }
+
+  return {std::move(snapshot), std::error_code()};
+}
+
+} // namespace ml
@@ -0,0 +1,209 @@
+#include "ml/Basic/ConcurrentArena.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <iostream>
+
+namespace {
+
+/// A thread's bump region within one ConcurrentArena.
+struct ThreadRegion {
+  uint64_t epoch = 0;
+  char *current = nullptr;
+  char *end = nullptr;
+};
+
+/// The number of arenas a thread can hold regions in at once.
+constexpr size_t kThreadRegionSlots = 4;
+
+/// Source of unique arena epochs; zero marks an empty slot.
+std::atomic<uint64_t> gNextEpoch{1};
+
+thread_local std::array<ThreadRegion, kThreadRegionSlots> sThreadRegions;
+thread_local size_t sNextEvictedSlot = 0;
+
+/// Bump-allocates from a region, or returns nullptr if it does not fit.
+inline void *bumpAllocate(ThreadRegion &region, size_t size,
+                          size_t alignment) {
+  uintptr_t addr = reinterpret_cast<uintptr_t>(region.current);
+  uintptr_t aligned = (addr + alignment - 1) & ~(alignment - 1);
+  if (aligned + size > reinterpret_cast<uintptr_t>(region.end)) {
+    return nullptr;
+  }
+
+  region.current = reinterpret_cast<char *>(aligned + size);
+  return reinterpret_cast<void *>(aligned);
+}
+
+} // namespace
+
+namespace ml {
+
+ConcurrentArena::ConcurrentArena(ArenaAllocator &parent)
+    : parent(parent), epoch(gNextEpoch.fetch_add(1)) {}
+
+void *ConcurrentArena::allocate(size_t size, size_t alignment) {
+  if (size == 0 || size > ArenaAllocator::kMaxAllocationSize) {
+    return nullptr;
+  }
+  assert(std::has_single_bit(alignment) || alignment == 0);
+  alignment = std::max(alignment, ArenaAllocator::kDefaultAlignment);
+
+  // Fast path: bump within this thread's region, no shared state touched
+  uint64_t currentEpoch = epoch.load(std::memory_order_relaxed);
+  for (ThreadRegion &region : sThreadRegions) {
+    if (region.epoch == currentEpoch) {
+      if (void *ptr = bumpAllocate(region, size, alignment)) {
+        return ptr;
+      }
+      break;
+    }
+  }
+
+  return allocateSlow(size, alignment);
+}
+
+void ConcurrentArena::deallocate(void *ptr, size_t size) {
+  if (!ptr) {
+    return;
+  }
+
+  uint64_t currentEpoch = epoch.load(std::memory_order_relaxed);
+  for (ThreadRegion &region : sThreadRegions) {
+    if (region.epoch == currentEpoch) {
+      // Roll back the bump pointer if ptr is the region's last allocation
+      char *begin = static_cast<char *>(ptr);
+      if (begin >= region.end - kRegionSize && begin + size == region.current) {
+        region.current = begin;
+      }
+      return;
+    }
+  }
+}
+
+void *ConcurrentArena::allocateSlow(size_t size, size_t alignment) {
+  // Large requests would waste most of a region; serve them directly
+  size_t neededSize = size + alignment - 1;
+  if (neededSize > kRegionSize / 2) {
+    return allocateFromParent(size, alignment);
+  }
+
+  char *regionStart = carve(kRegionSize);
+  if (!regionStart) {
+    return nullptr;
+  }
+
+  // Reuse this arena's slot, or evict another arena's slot
+  uint64_t currentEpoch = epoch.load(std::memory_order_relaxed);
+  ThreadRegion *slot = nullptr;
+  for (ThreadRegion &region : sThreadRegions) {
+    if (region.epoch == currentEpoch) {
+      slot = &region;
+      break;
+    }
+  }
+  if (!slot) {
+    slot = &sThreadRegions[sNextEvictedSlot];
+    sNextEvictedSlot = (sNextEvictedSlot + 1) % kThreadRegionSlots;
+  }
+
+  slot->epoch = currentEpoch;
+  slot->current = regionStart;
+  slot->end = regionStart + kRegionSize;
+
+  refillCount.fetch_add(1, std::memory_order_relaxed);
+  handedOutCount.fetch_add(kRegionSize, std::memory_order_relaxed);
+
+  return bumpAllocate(*slot, size, alignment);
+}
+
+char *ConcurrentArena::carve(size_t size) {
+  while (true) {
+    // Lock-free: claim a range of the current block
+    Block *block = currentBlock.load(std::memory_order_acquire);
+    if (block) {
+      size_t offset = block->offset.fetch_add(size, std::memory_order_relaxed);
+      if (offset + size <= block->size) {
+        return block->getData() + offset;
+      }
+    }
+
+    // The block is exhausted; only one thread replaces it
+    std::lock_guard<std::mutex> lock(Mutex);
+    if (currentBlock.load(std::memory_order_acquire) != block) {
+      continue;
+    }
+
+    void *memory = parent.allocate(kBlockSize, alignof(Block));
+    if (!memory) {
+      return nullptr;
+    }
+
+    Block *newBlock = new (memory) Block();
+    newBlock->offset.store(0, std::memory_order_relaxed);
+    newBlock->size = kBlockSize - sizeof(Block);
+
+    allocatedCount.fetch_add(kBlockSize, std::memory_order_relaxed);
+    blockCount.fetch_add(1, std::memory_order_relaxed);
+    currentBlock.store(newBlock, std::memory_order_release);
+  }
+}
+
+void *ConcurrentArena::allocateFromParent(size_t size, size_t alignment) {
+  std::lock_guard<std::mutex> lock(Mutex);
+  void *ptr = parent.allocate(size, alignment);
+  if (ptr) {
+    refillCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedCount.fetch_add(size, std::memory_order_relaxed);
+    handedOutCount.fetch_add(size, std::memory_order_relaxed);
+  }
+  return ptr;
+}
+
+char *ConcurrentArena::allocateString(const char *str, size_t length) {
+  if (!str) {
+    return nullptr;
+  }
+
+  // Allocate space for string + null terminator
+  char *result = static_cast<char *>(allocate(length + 1, 1));
+  if (result) {
+    std::memcpy(result, str, length);
+    result[length] = '\0';
+  }
+
+  return result;
+}
+
+void ConcurrentArena::reset() {
+  // A new epoch orphans every thread's region for this arena
+  epoch.store(gNextEpoch.fetch_add(1), std::memory_order_relaxed);
+  currentBlock.store(nullptr, std::memory_order_release);
+
+  allocatedCount.store(0, std::memory_order_relaxed);
+  blockCount.store(0, std::memory_order_relaxed);
+  refillCount.store(0, std::memory_order_relaxed);
+  handedOutCount.store(0, std::memory_order_relaxed);
+}
+
+ArenaStats ConcurrentArena::getStats() const {
+  ArenaStats stats;
+  stats.allocatedCount = allocatedCount.load(std::memory_order_relaxed);
+  stats.chunkCount = blockCount.load(std::memory_order_relaxed);
+  stats.allocationCount = refillCount.load(std::memory_order_relaxed);
+  stats.currentUsage = handedOutCount.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void ConcurrentArena::printStats(std::ostream &OS) const {
+  auto stats = getStats();
+
+  OS << "Concurrent Arena Statistics:\n";
+  OS << "  Taken from parent: " << stats.allocatedCount << " bytes\n";
+  OS << "  Handed to threads: " << stats.currentUsage << " bytes\n";
+  OS << "  Shared blocks: " << stats.chunkCount << "\n";
+  OS << "  Region refills: " << stats.allocationCount << "\n";
+}
+
+} // namespace ml
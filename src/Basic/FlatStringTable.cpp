@@ -0,0 +1,199 @@
+#include "ml/Basic/FlatStringTable.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+namespace ml {
+
+namespace {
+
+// Control byte of an empty slot; tags of occupied slots are below 0x80
+constexpr uint8_t kEmpty = 0x80;
+
+uint8_t getTag(uint32_t hash) { return static_cast<uint8_t>(hash & 0x7F); }
+
+// The tag takes the low bits, so group selection starts above them
+size_t getGroup(uint32_t hash, size_t groupMask) {
+  return (hash >> 7) & groupMask;
+}
+
+// Bit i is set where control byte i of the group equals the value
+uint32_t matchGroup(const uint8_t *group, uint8_t value) {
+#if defined(__SSE2__) || defined(_M_X64)
+  __m128i control =
+      _mm_loadu_si128(reinterpret_cast<const __m128i *>(group));
+  __m128i cmp =
+      _mm_cmpeq_epi8(control, _mm_set1_epi8(static_cast<char>(value)));
+  return static_cast<uint32_t>(_mm_movemask_epi8(cmp));
+#else
+  uint32_t mask = 0;
+  for (uint32_t i = 0; i < FlatStringTable::kGroupSize; ++i) {
+    if (group[i] == value) {
+      mask |= 1u << i;
+    }
+  }
+  return mask;
+#endif
+}
+
+} // namespace
+
+FlatStringTable::FlatStringTable(FlatStringTable &&other) noexcept
+    : Slots(std::move(other.Slots)), Control(std::move(other.Control)),
+      Capacity(other.Capacity), Count(other.Count) {
+  other.Capacity = 0;
+  other.Count = 0;
+}
+
+FlatStringTable &
+FlatStringTable::operator=(FlatStringTable &&other) noexcept {
+  if (this != &other) {
+    Slots = std::move(other.Slots);
+    Control = std::move(other.Control);
+    Capacity = other.Capacity;
+    Count = other.Count;
+
+    other.Capacity = 0;
+    other.Count = 0;
+  }
+  return *this;
+}
+
+const FlatStringTable::Entry *
+FlatStringTable::find(std::string_view str, size_t hash) const {
+  if (Count == 0) {
+    return nullptr;
+  }
+
+  auto storedHash = static_cast<uint32_t>(hash);
+  uint8_t tag = getTag(storedHash);
+  size_t groupMask = Capacity / kGroupSize - 1;
+  size_t group = getGroup(storedHash, groupMask);
+
+  // Triangular steps visit every group of a power-of-two table
+  for (size_t step = 1;; ++step) {
+    const uint8_t *control = Control.get() + group * kGroupSize;
+    for (uint32_t match = matchGroup(control, tag); match;
+         match &= match - 1) {
+      const Entry &entry =
+          Slots[group * kGroupSize +
+                static_cast<size_t>(std::countr_zero(match))];
+      if (entry.hash == storedHash && entry.size == str.size() &&
+          std::memcmp(entry.data, str.data(), str.size()) == 0) {
+        return &entry;
+      }
+    }
+
+    // A string is never placed past a group with room in it
+    if (matchGroup(control, kEmpty)) {
+      return nullptr;
+    }
+    group = (group + step) & groupMask;
+  }
+}
+
+void FlatStringTable::prefetch(size_t hash) const {
+  if (Capacity == 0) {
+    return;
+  }
+
+  size_t groupMask = Capacity / kGroupSize - 1;
+  size_t group = getGroup(static_cast<uint32_t>(hash), groupMask);
+  const uint8_t *control = Control.get() + group * kGroupSize;
+  const Entry *slots = Slots.get() + group * kGroupSize;
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_prefetch(control, 0, 3);
+  __builtin_prefetch(slots, 0, 3);
+#elif defined(_M_X64)
+  _mm_prefetch(reinterpret_cast<const char *>(control), _MM_HINT_T0);
+  _mm_prefetch(reinterpret_cast<const char *>(slots), _MM_HINT_T0);
+#else
+  (void)control;
+  (void)slots;
+#endif
+}
+
+const FlatStringTable::Entry &FlatStringTable::insert(std::string_view str,
+                                                      size_t hash) {
+  if (str.size() > UINT32_MAX) {
+    throw std::length_error("FlatStringTable: string too long");
+  }
+
+  // Keep at least one slot in eight empty so probes terminate quickly
+  if ((Count + 1) * 8 > Capacity * 7) {
+    rehash(std::max(Capacity * 2, kGroupSize));
+  }
+
+  auto storedHash = static_cast<uint32_t>(hash);
+  size_t slot = findEmptySlot(storedHash);
+  Control[slot] = getTag(storedHash);
+
+  Entry &entry = Slots[slot];
+  entry.data = str.data();
+  entry.size = static_cast<uint32_t>(str.size());
+  entry.hash = storedHash;
+  ++Count;
+  return entry;
+}
+
+void FlatStringTable::reserve(size_t count) {
+  size_t needed = std::bit_ceil(std::max(count + count / 7 + 1, kGroupSize));
+  if (needed > Capacity) {
+    rehash(needed);
+  }
+}
+
+void FlatStringTable::clear() {
+  Slots.reset();
+  Control.reset();
+  Capacity = 0;
+  Count = 0;
+}
+
+size_t FlatStringTable::findOccupied(size_t slot) const {
+  while (slot < Capacity && Control[slot] == kEmpty) {
+    ++slot;
+  }
+  return std::min(slot, Capacity);
+}
+
+size_t FlatStringTable::findEmptySlot(uint32_t hash) const {
+  size_t groupMask = Capacity / kGroupSize - 1;
+  size_t group = getGroup(hash, groupMask);
+
+  for (size_t step = 1;; ++step) {
+    uint32_t empty = matchGroup(Control.get() + group * kGroupSize, kEmpty);
+    if (empty) {
+      return group * kGroupSize +
+             static_cast<size_t>(std::countr_zero(empty));
+    }
+    group = (group + step) & groupMask;
+  }
+}
+
+void FlatStringTable::rehash(size_t newCapacity) {
+  std::unique_ptr<Entry[]> oldSlots = std::move(Slots);
+  std::unique_ptr<uint8_t[]> oldControl = std::move(Control);
+  size_t oldCapacity = Capacity;
+
+  Slots = std::make_unique<Entry[]>(newCapacity);
+  Control = std::make_unique<uint8_t[]>(newCapacity);
+  std::fill_n(Control.get(), newCapacity, kEmpty);
+  Capacity = newCapacity;
+
+  // Stored hashes place every entry without touching the strings
+  for (size_t i = 0; i < oldCapacity; ++i) {
+    if (oldControl[i] != kEmpty) {
+      size_t slot = findEmptySlot(oldSlots[i].hash);
+      Control[slot] = oldControl[i];
+      Slots[slot] = oldSlots[i];
+    }
+  }
+}
+
+} // namespace ml
@@ -0,0 +1,62 @@
+#include "ml/Basic/LocalStringTable.hpp"
+#include "ml/Basic/StringHash.hpp"
+#include <stdexcept>
+
+namespace ml {
+
+uint32_t LocalStringTable::intern(std::string_view str) {
+  if (str.empty()) {
+    return 0;
+  }
+
+  // Keep the index at most half full so probe runs stay short
+  if ((Strings.size() + 1) * 2 > Capacity) {
+    if (Strings.size() >= UINT32_MAX - 1) {
+      throw std::length_error("LocalStringTable: too many strings");
+    }
+    rehash(Capacity ? Capacity * 2 : 64);
+  }
+
+  auto hash = static_cast<uint32_t>(StringHash::hash(str));
+  size_t mask = Capacity - 1;
+  for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+    Slot &entry = Slots[slot];
+    if (entry.id == 0) {
+      Strings.push_back(str);
+      entry.hash = hash;
+      entry.id = static_cast<uint32_t>(Strings.size());
+      return entry.id;
+    }
+    if (entry.hash == hash && Strings[entry.id - 1] == str) {
+      return entry.id;
+    }
+  }
+}
+
+void LocalStringTable::clear() {
+  Slots.reset();
+  Capacity = 0;
+  Strings.clear();
+}
+
+void LocalStringTable::rehash(size_t newCapacity) {
+  std::unique_ptr<Slot[]> oldSlots = std::move(Slots);
+  size_t oldCapacity = Capacity;
+
+  Slots = std::make_unique<Slot[]>(newCapacity);
+  Capacity = newCapacity;
+
+  // Stored hashes place every slot without touching the strings
+  size_t mask = Capacity - 1;
+  for (size_t i = 0; i < oldCapacity; ++i) {
+    if (oldSlots[i].id != 0) {
+      size_t slot = oldSlots[i].hash & mask;
+      while (Slots[slot].id != 0) {
+        slot = (slot + 1) & mask;
+      }
+      Slots[slot] = oldSlots[i];
+    }
+  }
+}
+
+} // namespace ml
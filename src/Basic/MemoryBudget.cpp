@@ -0,0 +1,128 @@
+#include "ml/Basic/MemoryBudget.hpp"
+#include <algorithm>
+#include <iostream>
+
+namespace ml {
+
+MemoryBudget::Client *MemoryBudget::registerClient(std::string name,
+                                                   EvictCallback evict) {
+  auto client = std::make_unique<Client>(std::move(name), std::move(evict));
+  Client *result = client.get();
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  Clients.push_back(std::move(client));
+  return result;
+}
+
+void MemoryBudget::unregisterClient(Client *client) {
+  if (!client) {
+    return;
+  }
+  release(client, client->getUsedBytes());
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  auto it = std::find_if(Clients.begin(), Clients.end(),
+                         [client](const auto &ptr) {
+                           return ptr.get() == client;
+                         });
+  if (it != Clients.end()) {
+    Clients.erase(it);
+  }
+}
+
+void MemoryBudget::setOverflowHandler(OverflowHandler handler) {
+  std::lock_guard<std::mutex> lock(Mutex);
+  overflowHandler = std::move(handler);
+}
+
+bool MemoryBudget::reclaim(const Client &client) {
+  OverflowHandler handler;
+  size_t used = 0;
+  size_t currentLimit = 0;
+
+  {
+    std::lock_guard<std::mutex> lock(Mutex);
+
+    for (const auto &candidate : Clients) {
+      used = getUsedBytes();
+      currentLimit = getLimit();
+      if (used <= currentLimit) {
+        return true;
+      }
+      if (!candidate->evict) {
+        continue;
+      }
+
+      ++evictionCount;
+      evictedBytes += candidate->evict(used - currentLimit);
+    }
+
+    used = getUsedBytes();
+    currentLimit = getLimit();
+    if (used <= currentLimit) {
+      return true;
+    }
+
+    ++overflowCount;
+
+    // Latch the episode only once someone hears of it, so an overflow
+    // before a handler is installed is reported on the next one
+    if (!overflowHandler ||
+        overflowed.exchange(true, std::memory_order_relaxed)) {
+      return false;
+    }
+    handler = overflowHandler;
+  }
+
+  // Report without the lock; the handler may allocate and charge again
+  if (handler) {
+    handler(client, used, currentLimit);
+  }
+  return false;
+}
+
+void MemoryBudget::updatePeak(size_t used) {
+  size_t peak = peakBytes.load(std::memory_order_relaxed);
+  while (used > peak &&
+         !peakBytes.compare_exchange_weak(peak, used,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+MemoryBudgetStats MemoryBudget::getStats() const {
+  std::lock_guard<std::mutex> lock(Mutex);
+
+  MemoryBudgetStats stats;
+  stats.limit = getLimit();
+  stats.usedBytes = getUsedBytes();
+  stats.peakBytes = peakBytes.load(std::memory_order_relaxed);
+  stats.evictionCount = evictionCount;
+  stats.evictedBytes = evictedBytes;
+  stats.overflowCount = overflowCount;
+  return stats;
+}
+
+void MemoryBudget::printStats(std::ostream &OS) const {
+  auto stats = getStats();
+
+  OS << "Memory Budget Statistics:\n";
+  OS << "  Limit: ";
+  if (stats.limit == SIZE_MAX) {
+    OS << "none\n";
+  } else {
+    OS << stats.limit << " bytes\n";
+  }
+  OS << "  Used: " << stats.usedBytes << " bytes\n";
+  OS << "  Peak: " << stats.peakBytes << " bytes\n";
+  OS << "  Evictions: " << stats.evictionCount << " (" << stats.evictedBytes
+     << " bytes freed)\n";
+  OS << "  Overflows: " << stats.overflowCount << "\n";
+
+  std::lock_guard<std::mutex> lock(Mutex);
+  for (const auto &client : Clients) {
+    OS << "  " << client->getName() << ": " << client->getUsedBytes()
+       << " bytes\n";
+  }
+}
+
+} // namespace ml
@@ -0,0 +1,117 @@
+#include "ml/Basic/PerfectStringTable.hpp"
+#include <algorithm>
+#include <bit>
+#include <numeric>
+
+namespace ml {
+
+// Seeds tried per bucket before its strings are rejected
+static constexpr uint32_t kMaxSeedAttempts = 4096;
+
+std::unique_ptr<PerfectStringTable>
+PerfectStringTable::build(std::span<const Key> keys,
+                          std::vector<Key> &rejected) {
+  std::unique_ptr<PerfectStringTable> table(new PerfectStringTable());
+
+  // About four strings per bucket, and slots at most 80% full
+  size_t bucketCount = std::bit_ceil(std::max<size_t>(keys.size() / 4, 2));
+  size_t slotCount =
+      std::bit_ceil(std::max<size_t>(keys.size() + keys.size() / 4, 16));
+  table->BucketMask = bucketCount - 1;
+  table->BucketShift =
+      static_cast<unsigned>(64 - std::countr_zero(bucketCount));
+  table->SlotMask = slotCount - 1;
+  table->Seeds = std::make_unique<uint32_t[]>(bucketCount);
+  table->Slots = std::make_unique<Entry[]>(slotCount);
+
+  // Group the keys by bucket, and by hash within a bucket
+  std::vector<size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), size_t{0});
+  std::sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    size_t lhsBucket = table->getBucket(keys[lhs].hash);
+    size_t rhsBucket = table->getBucket(keys[rhs].hash);
+    return lhsBucket != rhsBucket ? lhsBucket < rhsBucket
+                                  : keys[lhs].hash < keys[rhs].hash;
+  });
+
+  struct Bucket {
+    size_t index;
+    size_t begin;
+    size_t end;
+  };
+  std::vector<Bucket> buckets;
+  for (size_t i = 0; i < order.size();) {
+    size_t bucket = table->getBucket(keys[order[i]].hash);
+    size_t end = i;
+    while (end < order.size() &&
+           table->getBucket(keys[order[end]].hash) == bucket) {
+      ++end;
+    }
+    buckets.push_back({bucket, i, end});
+    i = end;
+  }
+
+  // Place the largest buckets first, while most slots are free
+  std::stable_sort(buckets.begin(), buckets.end(),
+                   [](const Bucket &lhs, const Bucket &rhs) {
+                     return lhs.end - lhs.begin > rhs.end - rhs.begin;
+                   });
+
+  std::vector<const Key *> members;
+  std::vector<size_t> slots;
+  for (const Bucket &bucket : buckets) {
+    // No seed separates equal hashes; keep the first of each
+    members.clear();
+    for (size_t i = bucket.begin; i < bucket.end; ++i) {
+      const Key &key = keys[order[i]];
+      if (!members.empty() && members.back()->hash == key.hash) {
+        rejected.push_back(key);
+      } else {
+        members.push_back(&key);
+      }
+    }
+
+    bool placed = false;
+    for (uint32_t seed = 0; seed < kMaxSeedAttempts && !placed; ++seed) {
+      slots.clear();
+      placed = true;
+      for (const Key *key : members) {
+        size_t slot = table->getSlot(key->hash, seed);
+        if (table->Slots[slot].data ||
+            std::find(slots.begin(), slots.end(), slot) != slots.end()) {
+          placed = false;
+          break;
+        }
+        slots.push_back(slot);
+      }
+
+      if (placed) {
+        table->Seeds[bucket.index] = seed;
+        for (size_t i = 0; i < members.size(); ++i) {
+          Entry &entry = table->Slots[slots[i]];
+          entry.data = members[i]->str.data();
+          entry.size = static_cast<uint32_t>(members[i]->str.size());
+          entry.hash = static_cast<uint32_t>(members[i]->hash);
+        }
+        table->Count += members.size();
+      }
+    }
+
+    if (!placed) {
+      for (const Key *key : members) {
+        rejected.push_back(*key);
+      }
+    }
+  }
+
+  return table;
+}
+
+size_t PerfectStringTable::findOccupied(size_t slot) const {
+  while (slot <= SlotMask && !Slots[slot].data) {
+    ++slot;
+  }
+  return std::min(slot, getCapacity());
+}
+
+} // namespace ml
@@ -0,0 +1,484 @@
+#include "ml/Basic/SharedStringTable.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <new>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ml {
+
+// The atomics are shared between processes, so they must not hide a lock
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "SharedStringTable needs address-free atomics");
+
+namespace {
+
+/**
+ * \struct TableHeader
+ * \brief The start of the mapping.
+ * \details Offsets are from the start of the mapping. A new file reads as
+ * zeros, which is an empty index slot and an unrecorded symbol.
+ */
+struct TableHeader {
+  static constexpr uint64_t kMagic = 0x4C42545254534C4Dull; // "MLSTRTBL"
+  static constexpr uint32_t kVersion = 1;
+
+  uint64_t magic = kMagic;
+  uint32_t version = kVersion;
+  uint32_t maxStrings = 0;
+  uint64_t size = 0;
+  uint64_t symbolsOffset = 0;
+  uint64_t slotsOffset = 0;
+  uint64_t slotMask = 0;
+  uint64_t heapOffset = 0;
+
+  /**
+   * \brief The offset of the first free heap byte; may pass the end of
+   * the mapping once the heap is full.
+   */
+  std::atomic<uint64_t> heapTop{0};
+
+  /**
+   * \brief The next symbol ID; may pass \ref maxStrings once the table is
+   * full.
+   */
+  std::atomic<uint32_t> nextSymbol{1};
+
+  std::atomic<uint32_t> stringCount{0};
+
+  std::atomic<uint64_t> *getSymbols(char *data) const {
+    return reinterpret_cast<std::atomic<uint64_t> *>(data + symbolsOffset);
+  }
+
+  std::atomic<uint64_t> *getSlots(char *data) const {
+    return reinterpret_cast<std::atomic<uint64_t> *>(data + slotsOffset);
+  }
+};
+
+// Sections start on cache lines, so index slots never straddle one
+constexpr uint64_t kSectionAlignment = 64;
+
+uint64_t alignTo(uint64_t value, uint64_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+uint64_t getStoredSize(size_t length) {
+  return alignTo(sizeof(InternedStringHeader) + length + 1,
+                 alignof(InternedStringHeader));
+}
+
+// An index slot holds the high half of the hash and the symbol ID; IDs
+// start at 1, so an occupied slot is never zero
+uint64_t makeSlot(uint64_t hash, uint32_t id) {
+  return (hash & 0xFFFFFFFF00000000ull) | id;
+}
+
+struct Layout {
+  uint64_t symbolsOffset = 0;
+  uint64_t slotsOffset = 0;
+  uint64_t slotCount = 0;
+  uint64_t heapOffset = 0;
+  uint64_t size = 0;
+};
+
+// Places the sections of a table; false if the capacities cannot be mapped
+bool computeLayout(uint32_t maxStrings, uint64_t heapSize, Layout &layout) {
+  if (maxStrings == 0 || maxStrings == UINT32_MAX ||
+      heapSize < getStoredSize(0)) {
+    return false;
+  }
+
+  layout.symbolsOffset = alignTo(sizeof(TableHeader), kSectionAlignment);
+  layout.slotsOffset =
+      alignTo(layout.symbolsOffset + (uint64_t{maxStrings} + 1) * 8,
+              kSectionAlignment);
+  layout.slotCount = std::bit_ceil(std::max<uint64_t>(
+      uint64_t{maxStrings} * 2, kSectionAlignment / sizeof(uint64_t)));
+  layout.heapOffset = layout.slotsOffset + layout.slotCount * 8;
+  if (heapSize > SIZE_MAX - layout.heapOffset) {
+    return false;
+  }
+  layout.size = layout.heapOffset + heapSize;
+  return true;
+}
+
+TableHeader &getHeader(char *data) {
+  return *reinterpret_cast<TableHeader *>(data);
+}
+
+std::error_code getLastSystemError() {
+#ifdef _WIN32
+  return std::error_code(static_cast<int>(GetLastError()),
+                         std::system_category());
+#else
+  return std::error_code(errno, std::generic_category());
+#endif
+}
+
+void unmapFile(char *data, size_t size) {
+#ifdef _WIN32
+  (void)size;
+  UnmapViewOfFile(data);
+#else
+  munmap(data, size);
+#endif
+}
+
+// Maps a whole file read-write and shared
+std::error_code mapFile(const std::string &path, char *&data, size_t &size) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(
+      path.c_str(), GENERIC_READ | GENERIC_WRITE,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return getLastSystemError();
+  }
+
+  std::error_code error;
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize)) {
+    error = getLastSystemError();
+  } else if (static_cast<uint64_t>(fileSize.QuadPart) < sizeof(TableHeader)) {
+    error = std::make_error_code(std::errc::invalid_argument);
+  } else {
+    size = static_cast<size_t>(fileSize.QuadPart);
+    HANDLE mapping =
+        CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (mapping) {
+      data = static_cast<char *>(
+          MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+      CloseHandle(mapping);
+    }
+    if (!data) {
+      error = getLastSystemError();
+    }
+  }
+  CloseHandle(file);
+  return error;
+#else
+  int fd = ::open(path.c_str(), O_RDWR);
+  if (fd < 0) {
+    return getLastSystemError();
+  }
+
+  std::error_code error;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0) {
+    error = getLastSystemError();
+  } else if (static_cast<size_t>(fileStat.st_size) < sizeof(TableHeader)) {
+    error = std::make_error_code(std::errc::invalid_argument);
+  } else {
+    size = static_cast<size_t>(fileStat.st_size);
+    void *mapping =
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      error = getLastSystemError();
+    } else {
+      data = static_cast<char *>(mapping);
+    }
+  }
+  ::close(fd);
+  return error;
+#endif
+}
+
+// Creates an empty table at a path that must not exist yet
+std::error_code createFile(const std::string &path, const Layout &layout,
+                           uint32_t maxStrings) {
+  char *data = nullptr;
+#ifdef _WIN32
+  HANDLE file = CreateFileA(
+      path.c_str(), GENERIC_READ | GENERIC_WRITE,
+      FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+      CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    return getLastSystemError();
+  }
+
+  // Mapping past the end of the file grows it, filled with zeros
+  HANDLE mapping = CreateFileMappingA(
+      file, nullptr, PAGE_READWRITE, static_cast<DWORD>(layout.size >> 32),
+      static_cast<DWORD>(layout.size), nullptr);
+  if (mapping) {
+    data = static_cast<char *>(
+        MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0));
+    CloseHandle(mapping);
+  }
+  std::error_code error = data ? std::error_code() : getLastSystemError();
+  CloseHandle(file);
+#else
+  int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+  if (fd < 0) {
+    return getLastSystemError();
+  }
+
+  // Growing the file fills it with zeros
+  std::error_code error;
+  if (ftruncate(fd, static_cast<off_t>(layout.size)) != 0) {
+    error = getLastSystemError();
+  } else {
+    void *mapping = mmap(nullptr, layout.size, PROT_READ | PROT_WRITE,
+                         MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      error = getLastSystemError();
+    } else {
+      data = static_cast<char *>(mapping);
+    }
+  }
+  ::close(fd);
+#endif
+  if (error) {
+    return error;
+  }
+
+  auto *header = new (data) TableHeader();
+  header->maxStrings = maxStrings;
+  header->size = layout.size;
+  header->symbolsOffset = layout.symbolsOffset;
+  header->slotsOffset = layout.slotsOffset;
+  header->slotMask = layout.slotCount - 1;
+  header->heapOffset = layout.heapOffset;
+
+  // Symbol 0 is the empty string, stored first in the heap
+  new (data + layout.heapOffset)
+      InternedStringHeader{InternedStringHeader::computeHash(""), 0, 0};
+  header->heapTop.store(layout.heapOffset + getStoredSize(0),
+                        std::memory_order_relaxed);
+  header->getSymbols(data)[0].store(layout.heapOffset,
+                                    std::memory_order_relaxed);
+
+  unmapFile(data, layout.size);
+  return {};
+}
+
+// Moves a finished file to a path without replacing an existing file
+std::error_code linkFile(const std::string &from, const std::string &to) {
+#ifdef _WIN32
+  std::error_code error;
+  if (!MoveFileExA(from.c_str(), to.c_str(), 0)) {
+    error = getLastSystemError();
+    DeleteFileA(from.c_str());
+  }
+  return error;
+#else
+  std::error_code error;
+  if (::link(from.c_str(), to.c_str()) != 0) {
+    error = getLastSystemError();
+  }
+  ::unlink(from.c_str());
+  return error;
+#endif
+}
+
+std::string getTempPath(const std::string &path) {
+  static std::atomic<unsigned> counter{0};
+#ifdef _WIN32
+  unsigned long pid = GetCurrentProcessId();
+#else
+  long pid = static_cast<long>(getpid());
+#endif
+  return path + ".tmp." + std::to_string(pid) + "." +
+         std::to_string(counter++);
+}
+
+} // namespace
+
+SharedStringTable::~SharedStringTable() { unmapFile(data, mappingSize); }
+
+std::pair<std::unique_ptr<SharedStringTable>, std::error_code>
+SharedStringTable::open(const std::string &path, uint32_t maxStrings,
+                        size_t heapSize) {
+  char *data = nullptr;
+  size_t size = 0;
+  std::error_code error = mapFile(path, data, size);
+  if (error == std::errc::no_such_file_or_directory) {
+    Layout layout;
+    if (!computeLayout(maxStrings, heapSize, layout)) {
+      return {nullptr, std::make_error_code(std::errc::invalid_argument)};
+    }
+
+    // Build the table aside, so no process maps it half made
+    std::string tempPath = getTempPath(path);
+    if ((error = createFile(tempPath, layout, maxStrings))) {
+      std::error_code ignored;
+      std::filesystem::remove(tempPath, ignored);
+      return {nullptr, error};
+    }
+    error = linkFile(tempPath, path);
+    if (error && error != std::errc::file_exists) {
+      return {nullptr, error};
+    }
+
+    // Ours, or the file of a process that got there first
+    error = mapFile(path, data, size);
+  }
+  if (error) {
+    return {nullptr, error};
+  }
+
+  // The mapping is owned from here on, so failures below unmap it
+  std::unique_ptr<SharedStringTable> table(new SharedStringTable(data, size));
+
+  const TableHeader &header = getHeader(table->data);
+  Layout layout;
+  if (header.magic != TableHeader::kMagic ||
+      header.version != TableHeader::kVersion ||
+      header.size != size || header.heapOffset > size ||
+      !computeLayout(header.maxStrings, size - header.heapOffset, layout) ||
+      header.symbolsOffset != layout.symbolsOffset ||
+      header.slotsOffset != layout.slotsOffset ||
+      header.slotMask != layout.slotCount - 1 ||
+      header.heapOffset != layout.heapOffset ||
+      header.heapTop.load(std::memory_order_relaxed) < header.heapOffset) {
+    return {nullptr, std::make_error_code(std::errc::invalid_argument)};
+  }
+
+  return {std::move(table), std::error_code()};
+}
+
+InternedString SharedStringTable::intern(std::string_view str) {
+  if (str.empty()) {
+    return InternedString(getSymbolData(0));
+  }
+
+  uint64_t hash = InternedStringHeader::computeHash(str);
+  size_t slot = 0;
+  if (const char *found = find(str, hash, slot)) {
+    return InternedString(found);
+  }
+
+  TableHeader &header = getHeader(data);
+  auto *slots = header.getSlots(data);
+  uint32_t id = append(str, hash);
+  uint64_t desired = makeSlot(hash, id);
+
+  // Publish the copy; a slot taken meanwhile may hold the same string
+  for (;; slot = (slot + 1) & header.slotMask) {
+    uint64_t expected = 0;
+    if (slots[slot].compare_exchange_strong(expected, desired,
+                                            std::memory_order_acq_rel,
+                                            std::memory_order_acquire)) {
+      header.stringCount.fetch_add(1, std::memory_order_relaxed);
+      return InternedString(getSymbolData(id));
+    }
+
+    if ((expected ^ hash) >> 32 == 0) {
+      const char *other = getSymbolData(static_cast<uint32_t>(expected));
+      if (other && InternedStringHeader::fromData(other)->length ==
+                       str.size() &&
+          std::memcmp(other, str.data(), str.size()) == 0) {
+        // The copy is unreachable; its ID stays unused
+        header.getSymbols(data)[id].store(0, std::memory_order_release);
+        return InternedString(other);
+      }
+    }
+  }
+}
+
+InternedString SharedStringTable::lookup(std::string_view str) const {
+  if (str.empty()) {
+    return InternedString(getSymbolData(0));
+  }
+  size_t slot = 0;
+  return InternedString(
+      find(str, InternedStringHeader::computeHash(str), slot));
+}
+
+InternedString SharedStringTable::getString(Symbol symbol) const {
+  return InternedString(getSymbolData(symbol.getID()));
+}
+
+size_t SharedStringTable::getSymbolCount() const {
+  const TableHeader &header = getHeader(data);
+  return std::min<size_t>(header.nextSymbol.load(std::memory_order_acquire),
+                          size_t{header.maxStrings} + 1);
+}
+
+size_t SharedStringTable::size() const {
+  return getHeader(data).stringCount.load(std::memory_order_relaxed);
+}
+
+size_t SharedStringTable::getHeapUsed() const {
+  const TableHeader &header = getHeader(data);
+  uint64_t top = header.heapTop.load(std::memory_order_relaxed);
+  return static_cast<size_t>(std::min<uint64_t>(top, mappingSize) -
+                             header.heapOffset);
+}
+
+const char *SharedStringTable::getSymbolData(uint32_t id) const {
+  if (id >= getSymbolCount()) {
+    return nullptr;
+  }
+  const TableHeader &header = getHeader(data);
+  uint64_t offset =
+      header.getSymbols(data)[id].load(std::memory_order_acquire);
+  return offset ? getStringAt(offset) : nullptr;
+}
+
+const char *SharedStringTable::find(std::string_view str, uint64_t hash,
+                                    size_t &slot) const {
+  const TableHeader &header = getHeader(data);
+  const auto *slots = header.getSlots(data);
+
+  // The index is at most half full, so the probe meets an empty slot
+  for (slot = hash & header.slotMask;; slot = (slot + 1) & header.slotMask) {
+    uint64_t value = slots[slot].load(std::memory_order_acquire);
+    if (value == 0) {
+      return nullptr;
+    }
+    if ((value ^ hash) >> 32 != 0) {
+      continue;
+    }
+
+    const char *stored = getSymbolData(static_cast<uint32_t>(value));
+    if (stored &&
+        InternedStringHeader::fromData(stored)->length == str.size() &&
+        std::memcmp(stored, str.data(), str.size()) == 0) {
+      return stored;
+    }
+  }
+}
+
+uint32_t SharedStringTable::append(std::string_view str, uint64_t hash) {
+  if (str.size() > UINT32_MAX) {
+    throw std::length_error("SharedStringTable: string too long");
+  }
+
+  TableHeader &header = getHeader(data);
+  uint32_t id = header.nextSymbol.fetch_add(1, std::memory_order_relaxed);
+  if (id == 0 || id > header.maxStrings) {
+    throw std::length_error("SharedStringTable: too many strings");
+  }
+
+  uint64_t stored = getStoredSize(str.size());
+  uint64_t offset = header.heapTop.fetch_add(stored, std::memory_order_relaxed);
+  if (offset > mappingSize || stored > mappingSize - offset) {
+    throw std::bad_alloc();
+  }
+
+  // Only this process knows the bytes until the slot is published
+  auto *stringHeader = new (data + offset) InternedStringHeader{
+      hash, static_cast<uint32_t>(str.size()), id};
+  char *bytes = reinterpret_cast<char *>(stringHeader + 1);
+  std::memcpy(bytes, str.data(), str.size());
+  bytes[str.size()] = '\0';
+
+  header.getSymbols(data)[id].store(offset, std::memory_order_release);
+  return id;
+}
+
+} // namespace ml
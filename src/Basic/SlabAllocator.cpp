@@ -0,0 +1,354 @@
+#include "ml/Basic/SlabAllocator.hpp"
+#include <algorithm>
+#include <array>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+/// The number of allocators a thread can hold magazines for at once.
+constexpr size_t kThreadCacheSlots = 4;
+
+/// Source of unique allocator epochs; zero marks an empty slot.
+std::atomic<uint64_t> gNextEpoch{1};
+
+/// Guards \ref getRegistry().
+std::mutex &getRegistryMutex() {
+  // Leaked so it outlives thread-local caches flushed at exit
+  static std::mutex *registryMutex = new std::mutex();
+  return *registryMutex;
+}
+
+/// Live allocators by epoch, so exiting threads can return their blocks.
+std::unordered_map<uint64_t, ml::SlabAllocator *> &getRegistry() {
+  static auto *registry =
+      new std::unordered_map<uint64_t, ml::SlabAllocator *>();
+  return *registry;
+}
+
+} // namespace
+
+namespace ml {
+
+/// A thread's magazines, one set per allocator it has recently used.
+struct SlabThreadCache {
+  struct Slot {
+    uint64_t epoch = 0;
+    std::vector<SlabAllocator::Magazine> magazines;
+  };
+
+  std::array<Slot, kThreadCacheSlots> slots;
+  size_t nextEvictedSlot = 0;
+
+  ~SlabThreadCache() {
+    for (Slot &slot : slots) {
+      release(slot);
+    }
+  }
+
+  /// Returns a slot's blocks to its allocator, if it is still alive.
+  static void release(Slot &slot) {
+    if (slot.epoch == 0) {
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(getRegistryMutex());
+      auto it = getRegistry().find(slot.epoch);
+      if (it != getRegistry().end()) {
+        for (size_t i = 0; i < slot.magazines.size(); ++i) {
+          it->second->flush(i, slot.magazines[i], slot.magazines[i].count);
+        }
+      }
+    }
+
+    slot.epoch = 0;
+    slot.magazines.clear();
+  }
+};
+
+namespace {
+thread_local SlabThreadCache sThreadCache;
+} // namespace
+
+SlabAllocator::SlabAllocator(size_t slabSize)
+    : slabSize(std::clamp(slabSize, kMinBlockSize,
+                          ArenaAllocator::kMaxAllocationSize)),
+      epoch(gNextEpoch.fetch_add(1)) {
+  std::vector<size_t> sizeClasses;
+  for (size_t size = kMinBlockSize; size <= kMaxDefaultBlockSize; size *= 2) {
+    sizeClasses.push_back(size);
+  }
+  initialize(std::move(sizeClasses));
+}
+
+SlabAllocator::SlabAllocator(std::vector<size_t> sizeClasses, size_t slabSize)
+    : slabSize(std::clamp(slabSize, kMinBlockSize,
+                          ArenaAllocator::kMaxAllocationSize)),
+      epoch(gNextEpoch.fetch_add(1)) {
+  initialize(std::move(sizeClasses));
+}
+
+SlabAllocator::~SlabAllocator() {
+  // Blocks still cached by other threads are simply dropped with the arena
+  std::lock_guard<std::mutex> lock(getRegistryMutex());
+  getRegistry().erase(epoch);
+}
+
+void SlabAllocator::initialize(std::vector<size_t> sizeClasses) {
+  for (size_t &size : sizeClasses) {
+    size = std::max(size, kMinBlockSize);
+    size = (size + kMinBlockSize - 1) & ~(kMinBlockSize - 1);
+  }
+  std::sort(sizeClasses.begin(), sizeClasses.end());
+  sizeClasses.erase(std::unique(sizeClasses.begin(), sizeClasses.end()),
+                    sizeClasses.end());
+  sizeClasses.erase(std::upper_bound(sizeClasses.begin(), sizeClasses.end(),
+                                     slabSize),
+                    sizeClasses.end());
+
+  // Class indices are stored in a byte-sized lookup table
+  if (sizeClasses.size() >= UINT8_MAX) {
+    throw std::invalid_argument("SlabAllocator: too many size classes");
+  }
+
+  classCount = sizeClasses.size();
+  Classes = std::make_unique<SizeClass[]>(classCount);
+  for (size_t i = 0; i < classCount; ++i) {
+    Classes[i].blockSize = sizeClasses[i];
+  }
+
+  // Map every request size, in kMinBlockSize units, to the smallest class
+  // that fits it
+  if (classCount > 0) {
+    ClassIndex.resize(sizeClasses.back() / kMinBlockSize + 1);
+    size_t index = 0;
+    for (size_t slot = 0; slot < ClassIndex.size(); ++slot) {
+      while (sizeClasses[index] < slot * kMinBlockSize) {
+        ++index;
+      }
+      ClassIndex[slot] = static_cast<uint8_t>(index);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(getRegistryMutex());
+  getRegistry()[epoch] = this;
+}
+
+void *SlabAllocator::allocate(size_t size, size_t alignment) {
+  if (size == 0) {
+    return nullptr;
+  }
+
+  size_t index = getClassIndex(size);
+  if (index == classCount || alignment > kMinBlockSize) {
+    largeAllocationCount.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size,
+                          std::align_val_t(std::max(alignment, kMinBlockSize)),
+                          std::nothrow);
+  }
+
+  Magazine &magazine = getMagazines()[index];
+  if (!magazine.head && !refill(index, magazine)) {
+    return nullptr;
+  }
+
+  FreeNode *node = magazine.head;
+  magazine.head = node->next;
+  --magazine.count;
+
+  SizeClass &sizeClass = Classes[index];
+  sizeClass.allocationCount.fetch_add(1, std::memory_order_relaxed);
+  recordUsage(sizeClass.blockSize);
+  return node;
+}
+
+void SlabAllocator::deallocate(void *ptr, size_t size, size_t alignment) {
+  if (!ptr) {
+    return;
+  }
+
+  size_t index = getClassIndex(size);
+  if (index == classCount || alignment > kMinBlockSize) {
+    ::operator delete(ptr,
+                      std::align_val_t(std::max(alignment, kMinBlockSize)));
+    return;
+  }
+
+  Magazine &magazine = getMagazines()[index];
+  FreeNode *node = static_cast<FreeNode *>(ptr);
+  node->next = magazine.head;
+  magazine.head = node;
+  ++magazine.count;
+
+  SizeClass &sizeClass = Classes[index];
+  sizeClass.deallocationCount.fetch_add(1, std::memory_order_relaxed);
+  currentUsage.fetch_sub(sizeClass.blockSize, std::memory_order_relaxed);
+
+  // Keep a full magazine's worth cached and return the rest
+  if (magazine.count >= 2 * kMagazineSize) {
+    flush(index, magazine, kMagazineSize);
+  }
+}
+
+void SlabAllocator::flushThreadCache() {
+  for (SlabThreadCache::Slot &slot : sThreadCache.slots) {
+    if (slot.epoch == epoch) {
+      for (size_t i = 0; i < slot.magazines.size(); ++i) {
+        flush(i, slot.magazines[i], slot.magazines[i].count);
+      }
+      return;
+    }
+  }
+}
+
+SlabAllocator::Magazine *SlabAllocator::getMagazines() {
+  SlabThreadCache &cache = sThreadCache;
+  for (SlabThreadCache::Slot &slot : cache.slots) {
+    if (slot.epoch == epoch) {
+      return slot.magazines.data();
+    }
+  }
+
+  // Claim an empty slot, or evict another allocator's magazines
+  SlabThreadCache::Slot *slot = nullptr;
+  for (SlabThreadCache::Slot &candidate : cache.slots) {
+    if (candidate.epoch == 0) {
+      slot = &candidate;
+      break;
+    }
+  }
+  if (!slot) {
+    slot = &cache.slots[cache.nextEvictedSlot];
+    cache.nextEvictedSlot = (cache.nextEvictedSlot + 1) % kThreadCacheSlots;
+    SlabThreadCache::release(*slot);
+  }
+
+  slot->epoch = epoch;
+  slot->magazines.assign(classCount, Magazine{});
+  return slot->magazines.data();
+}
+
+bool SlabAllocator::refill(size_t index, Magazine &magazine) {
+  SizeClass &sizeClass = Classes[index];
+  std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+
+  if (!sizeClass.freeList && !carveSlab(sizeClass)) {
+    return false;
+  }
+
+  size_t moved = 0;
+  while (sizeClass.freeList && moved < kMagazineSize) {
+    FreeNode *node = sizeClass.freeList;
+    sizeClass.freeList = node->next;
+    node->next = magazine.head;
+    magazine.head = node;
+    ++moved;
+  }
+
+  magazine.count += moved;
+  return true;
+}
+
+void SlabAllocator::flush(size_t index, Magazine &magazine, size_t count) {
+  if (count == 0) {
+    return;
+  }
+
+  SizeClass &sizeClass = Classes[index];
+  std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+
+  for (size_t i = 0; i < count; ++i) {
+    FreeNode *node = magazine.head;
+    magazine.head = node->next;
+    node->next = sizeClass.freeList;
+    sizeClass.freeList = node;
+  }
+
+  magazine.count -= count;
+}
+
+bool SlabAllocator::carveSlab(SizeClass &sizeClass) {
+  char *slab;
+  {
+    std::lock_guard<std::mutex> lock(ArenaMutex);
+    slab = static_cast<char *>(arena.allocate(slabSize));
+  }
+  if (!slab) {
+    return false;
+  }
+
+  // Link blocks in address order so consecutive allocations are adjacent
+  size_t blockCount = slabSize / sizeClass.blockSize;
+  FreeNode *head = sizeClass.freeList;
+  for (size_t i = blockCount; i > 0; --i) {
+    FreeNode *node =
+        reinterpret_cast<FreeNode *>(slab + (i - 1) * sizeClass.blockSize);
+    node->next = head;
+    head = node;
+  }
+
+  sizeClass.freeList = head;
+  ++sizeClass.slabCount;
+  return true;
+}
+
+void SlabAllocator::recordUsage(size_t bytes) {
+  size_t usage =
+      currentUsage.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = peakUsage.load(std::memory_order_relaxed);
+  while (usage > peak &&
+         !peakUsage.compare_exchange_weak(peak, usage,
+                                          std::memory_order_relaxed)) {
+  }
+}
+
+SlabStats SlabAllocator::getStats() const {
+  SlabStats stats;
+  for (size_t i = 0; i < classCount; ++i) {
+    const SizeClass &sizeClass = Classes[i];
+    std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+    stats.slabCount += sizeClass.slabCount;
+    stats.allocationCount +=
+        sizeClass.allocationCount.load(std::memory_order_relaxed);
+    stats.deallocationCount +=
+        sizeClass.deallocationCount.load(std::memory_order_relaxed);
+  }
+
+  stats.allocatedCount = stats.slabCount * slabSize;
+  stats.largeAllocationCount =
+      largeAllocationCount.load(std::memory_order_relaxed);
+  stats.currentUsage = currentUsage.load(std::memory_order_relaxed);
+  stats.peakUsage = peakUsage.load(std::memory_order_relaxed);
+  return stats;
+}
+
+void SlabAllocator::printStats(std::ostream &OS) const {
+  auto stats = getStats();
+
+  OS << "Slab Allocator Statistics:\n";
+  OS << "  Total allocated: " << stats.allocatedCount << " bytes\n";
+  OS << "  Current usage: " << stats.currentUsage << " bytes\n";
+  OS << "  Peak usage: " << stats.peakUsage << " bytes\n";
+  OS << "  Number of slabs: " << stats.slabCount << "\n";
+  OS << "  Blocks handed out: " << stats.allocationCount << "\n";
+  OS << "  Blocks returned: " << stats.deallocationCount << "\n";
+  OS << "  Large allocations: " << stats.largeAllocationCount << "\n";
+  OS << "  Utilization: " << std::fixed << std::setprecision(2)
+     << (stats.getUtilization() * 100.0) << "%\n";
+
+  OS << "\nSize class details:\n";
+  for (size_t i = 0; i < classCount; ++i) {
+    const SizeClass &sizeClass = Classes[i];
+    std::lock_guard<std::mutex> lock(sizeClass.Mutex);
+    OS << "  " << sizeClass.blockSize << " bytes: " << sizeClass.slabCount
+       << " slabs, "
+       << sizeClass.allocationCount.load(std::memory_order_relaxed) -
+              sizeClass.deallocationCount.load(std::memory_order_relaxed)
+       << " blocks in use\n";
+  }
+}
+
+} // namespace ml
@@ -1,266 +1,546 @@
 #include "ml/Basic/StringInterner.hpp"
 #include "ml/Basic/ArenaAllocator.hpp"
+#include "ml/Basic/ArenaProfiler.hpp"
+#include "ml/Basic/ConcurrentArena.hpp"
 #include <algorithm>
+#include <bit>
+#include <cstddef>
 #include <cstring>
 #include <iostream>
+#include <new>
 #include <shared_mutex>
+#include <stdexcept>
 
-#ifdef _MSC_VER
-#include <immintrin.h>
-#include <intrin.h>
-#elif defined(__GNUC__) || defined(__clang__)
-#include <x86intrin.h>
-#endif
-
-// SIMD-optimized string comparison
-static bool fast_string_equal(const char *a, const char *b, size_t len) {
-#if defined(__AVX2__) || (defined(_MSC_VER) && defined(__AVX2__))
-  // Use AVX2 for chunks of 32 bytes
-  while (len >= 32) {
-    __m256i chunk_a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a));
-    __m256i chunk_b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b));
-    __m256i cmp = _mm256_cmpeq_epi8(chunk_a, chunk_b);
-
-    if (_mm256_movemask_epi8(cmp) != static_cast<int>(0xFFFFFFFF)) {
-      return false;
-    }
+namespace ml {
 
-    a += 32;
-    b += 32;
-    len -= 32;
-  }
-#elif defined(__SSE2__) || (defined(_MSC_VER) && defined(__SSE2__))
-  // Use SSE2 for chunks of 16 bytes
-  while (len >= 16) {
-    __m128i chunk_a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a));
-    __m128i chunk_b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b));
-    __m128i cmp = _mm_cmpeq_epi8(chunk_a, chunk_b);
+// Chunk size of the per-shard arenas used without a caller-provided arena
+static constexpr size_t kShardChunkSize = 16 * 1024;
 
-    if (_mm_movemask_epi8(cmp) != 0xFFFF) {
-      return false;
-    }
+// The budget charge for a table slot, its control byte and spare capacity
+static constexpr size_t kEntryOverhead = sizeof(FlatStringTable::Entry) + 8;
 
-    a += 16;
-    b += 16;
-    len -= 16;
-  }
-#endif
+// The bytes an interned string occupies: its header, data and terminator
+static size_t getStoredSize(size_t length) {
+  return sizeof(InternedStringHeader) + length + 1;
+}
 
-  // Handle remaining bytes
-  return std::memcmp(a, b, len) == 0;
+// The memory an interned string adds to the budget: its table slot, and
+// its bytes unless an arena already charges them
+static size_t getBudgetCost(size_t length, bool copied) {
+  return copied ? kEntryOverhead + getStoredSize(length) : kEntryOverhead;
 }
 
-namespace ml {
+static size_t hashString(std::string_view str) {
+  return static_cast<size_t>(InternedStringHeader::computeHash(str));
+}
 
-// StringStorage implementation with arena allocation support
-StringInterner::StringStorage::StringStorage(std::string_view str,
-                                             ArenaAllocator *arena)
-    : size(str.size()), usesArena(arena != nullptr) {
-  // Allocate memory either from arena or heap
-  if (arena) {
-    // Use arena allocation for better memory locality
-    data = arena->allocateString(str.data(), str.size());
-    if (!data) {
-      throw std::bad_alloc();
-    }
-  } else {
-    // Use aligned heap allocation for SIMD operations
-    size_t aligned_size = (size + 16) & ~15;
-    auto heap_data = std::make_unique<char[]>(aligned_size);
+// The empty string is never stored; every interner shares this one
+static const char *getEmptyString() {
+  struct EmptyString {
+    InternedStringHeader header;
+    char data[1];
+  };
+  static_assert(offsetof(EmptyString, data) == sizeof(InternedStringHeader),
+                "The data must follow the header");
+
+  static const EmptyString empty = {
+      {InternedStringHeader::computeHash(""), 0, 0}, {'\0'}};
+  return empty.data;
+}
 
-    // Use fast copy for larger strings
-    if (size >= 32) {
-      std::memcpy(heap_data.get(), str.data(), size);
-    } else {
-      // Manual copy for small strings to avoid function call overhead
-      const char *src = str.data();
-      char *dst = heap_data.get();
-      for (size_t i = 0; i < size; ++i) {
-        dst[i] = src[i];
-      }
-    }
-    heap_data[size] = '\0'; // Null terminate
+// StringInterner implementation
+void StringInterner::initShards() {
+  Shards = std::make_unique<Shard[]>(kShardCount);
+}
 
-    // Transfer ownership to raw pointer
-    data = heap_data.release();
+uint32_t StringInterner::allocateSymbols(uint32_t count) {
+  uint32_t first = nextSymbol.fetch_add(count, std::memory_order_relaxed);
+  if (count > Symbol::kInvalidID - first) {
+    throw std::length_error("StringInterner: out of symbol IDs");
   }
+  return first;
 }
 
-StringInterner::StringStorage::~StringStorage() {
-  // Only delete if not using arena (arena manages its own memory)
-  if (!usesArena && data) {
-    delete[] data;
+const char *StringInterner::copyString(Shard &shard, std::string_view str,
+                                       uint64_t hash, uint32_t id) {
+  if (str.size() > UINT32_MAX) {
+    throw std::length_error("StringInterner: string too long");
+  }
+
+  ML_ARENA_PROFILE_SCOPE(Interner);
+  size_t size = getStoredSize(str.size());
+  size_t alignment = alignof(InternedStringHeader);
+  void *memory = nullptr;
+  if (concurrentArena) {
+    memory = concurrentArena->allocate(size, alignment);
+  } else if (arenaAllocator) {
+    // Shards share the arena, which is not thread-safe
+    std::lock_guard<std::mutex> lock(arenaMutex);
+    memory = arenaAllocator->allocate(size, alignment);
+  } else {
+    if (!shard.Strings) {
+      shard.Strings = std::make_unique<ArenaAllocator>(kShardChunkSize);
+    }
+    memory = shard.Strings->allocate(size, alignment);
+    shard.copiedBytes += size;
+  }
+
+  if (!memory) {
+    throw std::bad_alloc();
   }
+
+  auto *header = new (memory) InternedStringHeader;
+  header->hash = hash;
+  header->length = static_cast<uint32_t>(str.size());
+  header->id = id;
+
+  char *data = reinterpret_cast<char *>(header + 1);
+  std::memcpy(data, str.data(), str.size());
+  data[str.size()] = '\0';
+
+  setSymbolString(id, data);
+  return data;
 }
 
-StringInterner::StringStorage::StringStorage(StringStorage &&other) noexcept
-    : data(other.data), size(other.size), usesArena(other.usesArena) {
-  other.data = nullptr;
-  other.size = 0;
+std::pair<size_t, size_t> StringInterner::getSegmentSlot(uint32_t id) {
+  size_t block = id / kFirstSegmentSize + 1;
+  auto segment = static_cast<size_t>(std::bit_width(block) - 1);
+  size_t start = kFirstSegmentSize * ((size_t{1} << segment) - 1);
+  return {segment, id - start};
 }
 
-StringInterner::StringStorage &
-StringInterner::StringStorage::operator=(StringStorage &&other) noexcept {
-  if (this != &other) {
-    // Clean up current data
-    if (!usesArena && data) {
-      delete[] data;
+void StringInterner::setSymbolString(uint32_t id, const char *data) {
+  auto [segment, index] = getSegmentSlot(id);
+  auto *slots = SymbolSegments[segment].load(std::memory_order_acquire);
+  if (!slots) {
+    std::lock_guard<std::mutex> lock(symbolMutex);
+    slots = SymbolSegments[segment].load(std::memory_order_relaxed);
+    if (!slots) {
+      slots = new std::atomic<const char *>[kFirstSegmentSize << segment]();
+      SymbolSegments[segment].store(slots, std::memory_order_release);
     }
+  }
+  slots[index].store(data, std::memory_order_release);
+}
 
-    // Transfer ownership
-    data = other.data;
-    size = other.size;
-    usesArena = other.usesArena;
+void StringInterner::clearSymbols() {
+  for (auto &segment : SymbolSegments) {
+    delete[] segment.exchange(nullptr, std::memory_order_acq_rel);
+  }
+  nextSymbol.store(firstSymbol, std::memory_order_release);
+}
 
-    // Reset other
-    other.data = nullptr;
-    other.size = 0;
+const char *StringInterner::getSymbolData(uint32_t id) const {
+  if (id >= nextSymbol.load(std::memory_order_acquire)) {
+    return nullptr;
   }
-  return *this;
+
+  auto [segment, index] = getSegmentSlot(id);
+  const auto *slots = SymbolSegments[segment].load(std::memory_order_acquire);
+  return slots ? slots[index].load(std::memory_order_acquire) : nullptr;
 }
 
-// StringInterner implementation
-StringInterner::StringInterner() : arenaAllocator(nullptr) {
-  // Reserve some initial space to avoid early rehashing
-  Storage.reserve(1000);
-  LookupMap.reserve(1000);
+InternedString StringInterner::getString(Symbol symbol) const {
+  uint32_t id = symbol.getID();
+  if (id == 0) {
+    return InternedString(getEmptyString());
+  }
+  if (id < firstSymbol && Base) {
+    return Base->getString(symbol);
+  }
+  return InternedString(getSymbolData(id));
 }
 
+StringInterner::StringInterner() : arenaAllocator(nullptr) { initShards(); }
+
 StringInterner::StringInterner(ArenaAllocator &arena) : arenaAllocator(&arena) {
-  // Reserve some initial space to avoid early rehashing
-  Storage.reserve(1000);
-  LookupMap.reserve(1000);
+  initShards();
+}
+
+StringInterner::StringInterner(ConcurrentArena &arena)
+    : arenaAllocator(nullptr), concurrentArena(&arena) {
+  initShards();
 }
 
-StringInterner::~StringInterner() = default;
+StringInterner::~StringInterner() {
+  setMemoryBudget(nullptr);
+  clearSymbols();
+}
 
 StringInterner::StringInterner(StringInterner &&other) noexcept
-    : arenaAllocator(other.arenaAllocator), Storage(std::move(other.Storage)),
-      LookupMap(std::move(other.LookupMap)), stats(other.stats) {
+    : arenaAllocator(other.arenaAllocator),
+      concurrentArena(other.concurrentArena), Shards(std::move(other.Shards)),
+      Frozen(std::move(other.Frozen)), Base(other.Base),
+      firstSymbol(other.firstSymbol), budget(other.budget),
+      budgetClient(other.budgetClient) {
   other.arenaAllocator = nullptr;
+  other.concurrentArena = nullptr;
+  other.Base = nullptr;
+  other.firstSymbol = 1;
+  other.budget = nullptr;
+  other.budgetClient = nullptr;
+
+  for (size_t i = 0; i < kSegmentCount; ++i) {
+    SymbolSegments[i].store(
+        other.SymbolSegments[i].exchange(nullptr, std::memory_order_acq_rel),
+        std::memory_order_release);
+  }
+  nextSymbol.store(other.nextSymbol.exchange(1, std::memory_order_acq_rel),
+                   std::memory_order_release);
+
+  // Leave the moved-from interner empty but usable
+  other.initShards();
 }
 
 StringInterner &StringInterner::operator=(StringInterner &&other) noexcept {
   if (this != &other) {
-    std::unique_lock<std::shared_mutex> lock(Mutex);
-    std::unique_lock<std::shared_mutex> otherLock(other.Mutex);
-
-    Storage = std::move(other.Storage);
-    LookupMap = std::move(other.LookupMap);
-    stats = other.stats;
+    if (budget) {
+      budget->unregisterClient(budgetClient);
+    }
+    budget = other.budget;
+    budgetClient = other.budgetClient;
+    other.budget = nullptr;
+    other.budgetClient = nullptr;
+
+    // The old strings go to the other interner, which frees them
+    Shards.swap(other.Shards);
+    Frozen.swap(other.Frozen);
+    for (size_t i = 0; i < kSegmentCount; ++i) {
+      SymbolSegments[i].store(
+          other.SymbolSegments[i].exchange(
+              SymbolSegments[i].load(std::memory_order_acquire),
+              std::memory_order_acq_rel),
+          std::memory_order_release);
+    }
+    nextSymbol.store(
+        other.nextSymbol.exchange(nextSymbol.load(std::memory_order_acquire),
+                                  std::memory_order_acq_rel),
+        std::memory_order_release);
     arenaAllocator = other.arenaAllocator;
+    concurrentArena = other.concurrentArena;
+    Base = other.Base;
+    firstSymbol = other.firstSymbol;
+    other.Base = nullptr;
+    other.firstSymbol = 1;
+    other.clear();
 
     other.arenaAllocator = nullptr;
+    other.concurrentArena = nullptr;
   }
   return *this;
 }
 
 InternedString StringInterner::intern(std::string_view str) {
-  ++stats.lookupCount;
-
   // Early exit for empty strings
   if (str.empty()) {
-    static const char empty_str[] = "";
-    return InternedString(empty_str);
+    Shards[0].lookupCount.fetch_add(1, std::memory_order_relaxed);
+    return InternedString(getEmptyString());
   }
 
-  // Early optimization: compute string length once (for potential future use)
-  // size_t str_length = str.length();
+  size_t hash = hashString(str);
+
+  // Strings in the base layer keep its handles
+  if (Base) {
+    if (const char *data = Base->findExisting(str, hash)) {
+      return InternedString(data);
+    }
+  }
+
+  // Frozen strings need no lock and no counter
+  if (Frozen) {
+    if (const auto *entry = Frozen->find(str, hash)) {
+      return InternedString(entry->data);
+    }
+  }
+
+  Shard &shard = getShard(hash);
+  shard.lookupCount.fetch_add(1, std::memory_order_relaxed);
 
   // Fast path: check if already interned (shared lock)
   {
-    std::shared_lock<std::shared_mutex> lock(Mutex);
-    auto it = LookupMap.find(str);
-    if (it != LookupMap.end()) {
-      return InternedString(it->second);
+    std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+    if (const auto *entry = shard.Table.find(str, hash)) {
+      return InternedString(entry->data);
     }
   }
 
   // Slow path: need to intern the string (exclusive lock)
-  std::unique_lock<std::shared_mutex> lock(Mutex);
+  std::unique_lock<std::shared_mutex> lock(shard.Mutex);
 
   // Double-check that another thread didn't intern it while we were waiting
-  auto it = LookupMap.find(str);
-  if (it != LookupMap.end()) {
-    return InternedString(it->second);
+  if (const auto *entry = shard.Table.find(str, hash)) {
+    return InternedString(entry->data);
   }
 
-  // Create new storage for the string (using arena if available)
-  auto storage = std::make_unique<StringStorage>(str, arenaAllocator);
-  const char *ptr = storage->c_str();
+  const char *ptr = copyString(shard, str, hash, allocateSymbols(1));
+  shard.Table.insert(std::string_view(ptr, str.size()), hash);
+  size_t cost = getBudgetCost(str.size(), !isUsingArena());
 
-  // Reserve capacity if needed to avoid rehashing
-  if (Storage.size() >= Storage.bucket_count() * 0.75) {
-    Storage.reserve(Storage.size() * 2);
-    LookupMap.reserve(LookupMap.size() * 2);
+  ++shard.stats.internCount;
+  ++shard.stats.uniqueStringCount;
+  shard.stats.memoryUsedCount += str.size() + 1; // +1 for null terminator
+
+  // Charge outside the lock; an overflow report may intern strings itself
+  lock.unlock();
+  if (budget) {
+    budget->charge(budgetClient, cost);
   }
 
-  // Add to storage set
-  auto [storageIt, storageInserted] = Storage.insert(std::move(storage));
-  if (!storageInserted) {
-    // This should never happen with our current implementation
-    ++stats.collisionCount;
-    return InternedString((*storageIt)->c_str());
+  return InternedString(ptr);
+}
+
+void StringInterner::internBatch(std::span<const std::string_view> strs,
+                                 std::span<InternedString> out) {
+  if (out.size() < strs.size()) {
+    throw std::length_error("StringInterner: batch output too small");
   }
 
-  // Add to lookup map using the stored string as the key
-  std::string_view storedView(ptr, str.size());
-  LookupMap[storedView] = ptr;
+  // Blocks keep the scratch arrays on the stack and in cache, and are
+  // large enough that most shards see several strings per block
+  constexpr size_t kBlockSize = 512;
+  size_t hashes[kBlockSize];
+  uint32_t ids[kBlockSize];
+  uint16_t shardOf[kBlockSize];
+  uint16_t order[kBlockSize];
+  uint16_t misses[kBlockSize];
+  uint16_t firstOf[kBlockSize]; // First copy of a missed string
+  uint16_t runStart[kShardCount + 1];
+  constexpr uint16_t kNotNew = UINT16_MAX;
+
+  for (size_t base = 0; base < strs.size(); base += kBlockSize) {
+    size_t count = std::min(kBlockSize, strs.size() - base);
+
+    // Hash everything first, so the probes below do not wait on it
+    std::fill(std::begin(runStart), std::end(runStart), uint16_t{0});
+    for (size_t i = 0; i < count; ++i) {
+      std::string_view str = strs[base + i];
+      shardOf[i] = kShardCount;
+      firstOf[i] = kNotNew;
+      if (str.empty()) {
+        Shards[0].lookupCount.fetch_add(1, std::memory_order_relaxed);
+        out[base + i] = InternedString(getEmptyString());
+        continue;
+      }
 
-  // Update statistics efficiently
-  ++stats.internCount;
-  ++stats.uniqueStringCount;
-  size_t string_memory = str.size() + 1; // +1 for null terminator
-  stats.memoryUsedCount += string_memory;
+      size_t hash = hashString(str);
+      if (Base) {
+        if (const char *data = Base->findExisting(str, hash)) {
+          out[base + i] = InternedString(data);
+          continue;
+        }
+      }
+      if (Frozen) {
+        if (const auto *entry = Frozen->find(str, hash)) {
+          out[base + i] = InternedString(entry->data);
+          continue;
+        }
+      }
+      hashes[i] = hash;
+      shardOf[i] = static_cast<uint16_t>(getShardIndex(hash));
+      ++runStart[shardOf[i] + 1];
+    }
 
-  // Update average length using incremental formula
-  stats.averageLength =
-      (stats.averageLength * (stats.uniqueStringCount - 1) + str.size()) /
-      stats.uniqueStringCount;
+    // Group by shard with a counting sort, so each lock is taken once
+    for (size_t s = 0; s < kShardCount; ++s) {
+      runStart[s + 1] = static_cast<uint16_t>(runStart[s + 1] + runStart[s]);
+    }
+    uint16_t fill[kShardCount];
+    std::copy_n(runStart, kShardCount, fill);
+    for (size_t i = 0; i < count; ++i) {
+      if (shardOf[i] < kShardCount) {
+        order[fill[shardOf[i]]++] = static_cast<uint16_t>(i);
+      }
+    }
 
-  return InternedString(ptr);
-}
+    // Look everything up; misses stay grouped by shard
+    size_t missCount = 0;
+    for (size_t s = 0; s < kShardCount; ++s) {
+      size_t first = runStart[s];
+      size_t last = runStart[s + 1];
+      if (first == last) {
+        continue;
+      }
 
-InternedString StringInterner::lookup(std::string_view str) const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
+      Shard &shard = Shards[s];
+      shard.lookupCount.fetch_add(last - first, std::memory_order_relaxed);
+
+      std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+      for (size_t k = first; k < last; ++k) {
+        shard.Table.prefetch(hashes[order[k]]);
+      }
+      for (size_t k = first; k < last; ++k) {
+        size_t i = order[k];
+        const auto *entry = shard.Table.find(strs[base + i], hashes[i]);
+        if (entry) {
+          out[base + i] = InternedString(entry->data);
+        } else {
+          misses[missCount++] = order[k];
+        }
+      }
+    }
+    if (missCount == 0) {
+      continue;
+    }
+
+    // Number new strings in the order they first appear in the batch, so
+    // the same calls always produce the same symbols
+    std::copy_n(misses, missCount, order);
+    std::sort(order, order + missCount, [&](uint16_t lhs, uint16_t rhs) {
+      return hashes[lhs] != hashes[rhs] ? hashes[lhs] < hashes[rhs]
+                                        : lhs < rhs;
+    });
+    for (size_t k = 0, first = 0; k < missCount; ++k) {
+      size_t i = order[k];
+      if (k == 0 || hashes[order[first]] != hashes[i]) {
+        first = k;
+      }
+      firstOf[i] = static_cast<uint16_t>(i);
+      for (size_t j = first; j < k; ++j) {
+        if (strs[base + order[j]] == strs[base + i]) {
+          firstOf[i] = order[j];
+          break;
+        }
+      }
+    }
 
-  auto it = LookupMap.find(str);
-  if (it != LookupMap.end()) {
-    return InternedString(it->second);
+    uint32_t uniqueCount = 0;
+    for (size_t i = 0; i < count; ++i) {
+      ids[i] = uniqueCount;
+      if (firstOf[i] == i) {
+        ++uniqueCount;
+      }
+    }
+    uint32_t firstID = allocateSymbols(uniqueCount);
+
+    // Insert, one exclusive lock per shard. A string another thread added
+    // in the meantime is taken as is, leaving its reserved ID unused.
+    for (size_t k = 0; k < missCount;) {
+      size_t s = shardOf[misses[k]];
+      Shard &shard = Shards[s];
+      size_t cost = 0;
+      std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+      for (; k < missCount && shardOf[misses[k]] == s; ++k) {
+        size_t i = misses[k];
+        if (firstOf[i] != i) {
+          continue;
+        }
+
+        std::string_view str = strs[base + i];
+        if (const auto *entry = shard.Table.find(str, hashes[i])) {
+          out[base + i] = InternedString(entry->data);
+          continue;
+        }
+
+        const char *ptr = copyString(shard, str, hashes[i], firstID + ids[i]);
+        shard.Table.insert(std::string_view(ptr, str.size()), hashes[i]);
+        cost += getBudgetCost(str.size(), !isUsingArena());
+
+        ++shard.stats.internCount;
+        ++shard.stats.uniqueStringCount;
+        shard.stats.memoryUsedCount += str.size() + 1;
+        out[base + i] = InternedString(ptr);
+      }
+
+      lock.unlock();
+      if (budget) {
+        budget->charge(budgetClient, cost);
+      }
+    }
+
+    // Later copies of a new string share its handle
+    for (size_t k = 0; k < missCount; ++k) {
+      size_t i = misses[k];
+      if (firstOf[i] != i) {
+        out[base + i] = out[base + firstOf[i]];
+      }
+    }
   }
+}
 
-  return InternedString(); // Invalid/empty string
+const char *StringInterner::findExisting(std::string_view str,
+                                         size_t hash) const {
+  if (Base) {
+    if (const char *data = Base->findExisting(str, hash)) {
+      return data;
+    }
+  }
+  if (Frozen) {
+    if (const auto *entry = Frozen->find(str, hash)) {
+      return entry->data;
+    }
+  }
+
+  const Shard &shard = getShard(hash);
+  std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+  const auto *entry = shard.Table.find(str, hash);
+  return entry ? entry->data : nullptr;
+}
+
+InternedString StringInterner::lookup(std::string_view str) const {
+  if (str.empty()) {
+    return InternedString(getEmptyString());
+  }
+  // Invalid if not found
+  return InternedString(findExisting(str, hashString(str)));
 }
 
 bool StringInterner::contains(std::string_view str) const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
-  return LookupMap.count(str) > 0;
+  return str.empty() || findExisting(str, hashString(str)) != nullptr;
 }
 
 StringInternerStats StringInterner::getStats() const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
-  return stats;
+  StringInternerStats result;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    const Shard &shard = Shards[i];
+    result.lookupCount += shard.lookupCount.load(std::memory_order_relaxed);
+
+    std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+    result.internCount += shard.stats.internCount;
+    result.uniqueStringCount += shard.stats.uniqueStringCount;
+    result.memoryUsedCount += shard.stats.memoryUsedCount;
+  }
+
+  // Every unique string counts its null terminator in memoryUsedCount
+  if (result.uniqueStringCount > 0) {
+    result.averageLength =
+        static_cast<double>(result.memoryUsedCount -
+                            result.uniqueStringCount) /
+        static_cast<double>(result.uniqueStringCount);
+  }
+  return result;
 }
 
 void StringInterner::clear() {
-  std::unique_lock<std::shared_mutex> lock(Mutex);
+  for (size_t i = 0; i < kShardCount; ++i) {
+    Shard &shard = Shards[i];
+    std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+
+    shard.Table.clear();
+    shard.Strings.reset();
+    shard.copiedBytes = 0;
 
-  Storage.clear();
-  LookupMap.clear();
+    // Reset statistics
+    shard.stats = StringInternerStats{};
+    shard.lookupCount.store(0, std::memory_order_relaxed);
+  }
+  Frozen.reset();
+  clearSymbols();
 
-  // Reset statistics
-  stats = StringInternerStats{};
+  if (budget) {
+    budget->release(budgetClient, budgetClient->getUsedBytes());
+  }
 }
 
 size_t StringInterner::size() const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
-  return Storage.size();
+  size_t count = Frozen ? Frozen->size() : 0;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    std::shared_lock<std::shared_mutex> lock(Shards[i].Mutex);
+    count += Shards[i].Table.size();
+  }
+  return count;
 }
 
-bool StringInterner::empty() const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
-  return Storage.empty();
-}
+bool StringInterner::empty() const { return size() == 0; }
 
 void StringInterner::printStats(std::ostream &os) const {
   auto stats = getStats();
@@ -269,7 +549,6 @@ void StringInterner::printStats(std::ostream &os) const {
   os << "  Unique strings: " << stats.uniqueStringCount << "\n";
   os << "  Total lookups: " << stats.lookupCount << "\n";
   os << "  Strings interned: " << stats.internCount << "\n";
-  os << "  Hash collisions: " << stats.collisionCount << "\n";
   os << "  Memory used: " << stats.memoryUsedCount << " bytes\n";
   os << "  Average string length: " << stats.averageLength << " chars\n";
 
@@ -282,53 +561,260 @@ void StringInterner::printStats(std::ostream &os) const {
 }
 
 void StringInterner::reserve(size_t count) {
-  std::unique_lock<std::shared_mutex> lock(Mutex);
+  // Hashing spreads strings evenly, so each shard takes its share
+  size_t perShard = count / kShardCount + 1;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    Shard &shard = Shards[i];
+    std::unique_lock<std::shared_mutex> lock(shard.Mutex);
 
-  Storage.reserve(count);
-  LookupMap.reserve(count);
+    shard.Table.reserve(perShard);
+  }
 }
 
-size_t StringInterner::getMemoryUsage() const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
+void StringInterner::freeze() {
+  std::vector<PerfectStringTable::Key> keys;
+  keys.reserve(size());
+
+  auto addKey = [&](const FlatStringTable::Entry &entry) {
+    keys.push_back(
+        {entry.view(), InternedStringHeader::fromData(entry.data)->hash});
+  };
+  if (Frozen) {
+    for (size_t slot = Frozen->findOccupied(0); slot < Frozen->getCapacity();
+         slot = Frozen->findOccupied(slot + 1)) {
+      addKey(Frozen->getEntry(slot));
+    }
+  }
+  for (size_t i = 0; i < kShardCount; ++i) {
+    std::shared_lock<std::shared_mutex> lock(Shards[i].Mutex);
+    for (const auto &entry : Shards[i].Table) {
+      addKey(entry);
+    }
+  }
+
+  std::vector<PerfectStringTable::Key> rejected;
+  Frozen = PerfectStringTable::build(keys, rejected);
+
+  // Strings the perfect hash could not place stay in the overlay
+  for (size_t i = 0; i < kShardCount; ++i) {
+    std::unique_lock<std::shared_mutex> lock(Shards[i].Mutex);
+    Shards[i].Table.clear();
+  }
+  for (const auto &key : rejected) {
+    Shard &shard = getShard(static_cast<size_t>(key.hash));
+    std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+    shard.Table.insert(key.str, static_cast<size_t>(key.hash));
+  }
+}
+
+const StringTableImage *
+StringInterner::writeSnapshot(ArenaSnapshotWriter &writer) const {
+  auto *table = writer.create<StringTableImage>();
+
+  // Entries are prepended, so walking the symbols backwards lists them in
+  // insertion order and the same interner always writes the same image
+  for (uint32_t id = static_cast<uint32_t>(getSymbolCount());
+       id-- > firstSymbol;) {
+    const char *stored = getSymbolData(id);
+    if (!stored) {
+      continue;
+    }
+
+    // Copy the header too, so loading needs neither a copy nor a rehash
+    const auto *source = InternedStringHeader::fromData(stored);
+    void *memory = writer.allocate(getStoredSize(source->length),
+                                   alignof(InternedStringHeader));
+    auto *header = new (memory) InternedStringHeader(*source);
+    char *data = reinterpret_cast<char *>(header + 1);
+    std::memcpy(data, stored, source->length + 1);
+
+    auto *entry = writer.create<StringTableImage::Entry>();
+    entry->string.Data = data;
+    entry->string.size = source->length;
+    entry->next = table->first;
+    table->first = entry;
+    ++table->count;
+  }
 
-  size_t totalMemory = stats.memoryUsedCount; // String data
-  totalMemory += Storage.size() *
-                 sizeof(std::unique_ptr<StringStorage>); // Storage overhead
-  totalMemory += LookupMap.size() * (sizeof(std::string_view) +
-                                     sizeof(const char *)); // Map overhead
+  return table;
+}
+
+void StringInterner::loadSnapshot(const StringTableImage &table) {
+  size_t cost = 0;
+
+  // An image numbers its strings densely from firstSymbol, so a larger ID
+  // is corrupt; such strings are copied rather than allowed to exhaust
+  // the ID space
+  uint64_t idLimit = firstSymbol;
+  for (const auto *entry = table.first.get(); entry;
+       entry = entry->next.get()) {
+    idLimit += entry->string.size > 0;
+  }
+  idLimit = std::min<uint64_t>(idLimit, Symbol::kInvalidID);
+
+  // Reserve the image's IDs that are still free, so strings adopted in
+  // place keep the symbol recorded in their read-only headers
+  uint32_t maxID = 0;
+  for (const auto *entry = table.first.get(); entry;
+       entry = entry->next.get()) {
+    if (entry->string.size > 0) {
+      uint32_t id =
+          InternedStringHeader::fromData(entry->string.Data.get())->id;
+      if (id < idLimit) {
+        maxID = std::max(maxID, id);
+      }
+    }
+  }
+  uint32_t firstFree = nextSymbol.load(std::memory_order_relaxed);
+  uint32_t lastReserved = 0;
+  if (maxID != Symbol::kInvalidID) {
+    while (maxID >= firstFree &&
+           !nextSymbol.compare_exchange_weak(firstFree, maxID + 1,
+                                             std::memory_order_relaxed)) {
+    }
+    if (maxID >= firstFree) {
+      lastReserved = maxID;
+    }
+  }
+
+  for (const auto *entry = table.first.get(); entry;
+       entry = entry->next.get()) {
+    std::string_view str = entry->string.view();
+    if (str.empty()) {
+      continue;
+    }
+
+    size_t hash = hashString(str);
+    if ((Base && Base->findExisting(str, hash)) ||
+        (Frozen && Frozen->find(str, hash))) {
+      continue;
+    }
+
+    Shard &shard = getShard(hash);
+    std::unique_lock<std::shared_mutex> lock(shard.Mutex);
+    if (shard.Table.find(str, hash)) {
+      continue;
+    }
+
+    // The mapping owns the bytes; the table only records them. Strings
+    // whose ID is taken, or written with another hash function, are copied.
+    const auto *header = InternedStringHeader::fromData(str.data());
+    if (header->hash == hash && header->length == str.size() &&
+        header->id >= firstFree && header->id <= lastReserved &&
+        !getString(Symbol(header->id)).isValid()) {
+      shard.Table.insert(str, hash);
+      setSymbolString(header->id, str.data());
+      cost += getBudgetCost(str.size(), false);
+    } else {
+      const char *ptr = copyString(shard, str, hash, allocateSymbols(1));
+      shard.Table.insert(std::string_view(ptr, str.size()), hash);
+      cost += getBudgetCost(str.size(), !isUsingArena());
+    }
+
+    ++shard.stats.uniqueStringCount;
+    shard.stats.memoryUsedCount += str.size() + 1;
+  }
+
+  if (budget) {
+    budget->charge(budgetClient, cost);
+  }
+}
+
+void StringInterner::setMemoryBudget(MemoryBudget *newBudget) {
+  if (budget) {
+    budget->unregisterClient(budgetClient);
+  }
+
+  budget = newBudget;
+  budgetClient = budget ? budget->registerClient("interner") : nullptr;
+  if (!budget) {
+    return;
+  }
+
+  // Charge what is already interned
+  size_t cost = Frozen ? kEntryOverhead * Frozen->size() : 0;
+  for (size_t i = 0; i < kShardCount; ++i) {
+    const Shard &shard = Shards[i];
+    std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+    cost += kEntryOverhead * shard.Table.size() + shard.copiedBytes;
+  }
+  budget->charge(budgetClient, cost);
+}
+
+void StringInterner::setBaseLayer(const StringInterner *base) {
+  // clear() frees the shard arenas, but cannot give back a caller's arena
+  if (base && isUsingArena()) {
+    throw std::invalid_argument(
+        "StringInterner: a layer must own its string memory");
+  }
+  clear();
+  Base = base;
+  firstSymbol = base ? static_cast<uint32_t>(base->getSymbolCount()) : 1;
+  nextSymbol.store(firstSymbol, std::memory_order_release);
+}
+
+size_t StringInterner::getMemoryUsage() const {
+  size_t totalMemory = sizeof(Shard) * kShardCount;
+  if (Frozen) {
+    totalMemory += Frozen->getMemoryUsage();
+    totalMemory += Frozen->size() * sizeof(InternedStringHeader);
+  }
+  for (size_t i = 0; i < kShardCount; ++i) {
+    const Shard &shard = Shards[i];
+    std::shared_lock<std::shared_mutex> lock(shard.Mutex);
+
+    totalMemory += shard.stats.memoryUsedCount; // String data
+    totalMemory +=
+        shard.Table.size() * sizeof(InternedStringHeader); // Headers
+    totalMemory += shard.Table.getMemoryUsage(); // Table overhead
+  }
 
   return totalMemory;
 }
 
 // Iterator implementation
 StringInterner::const_iterator::const_iterator(const StringInterner *interner,
-                                               size_t index)
-    : interner(interner), index(index) {}
+                                               uint32_t id)
+    : interner(interner), id(id) {
+  settle();
+}
+
+void StringInterner::const_iterator::settle() {
+  if (!interner || id == Symbol::kInvalidID) {
+    return;
+  }
+
+  auto count = static_cast<uint32_t>(interner->getSymbolCount());
+  while (id < count && !interner->getSymbolData(id)) {
+    ++id;
+  }
+  if (id >= count) {
+    id = Symbol::kInvalidID;
+  }
+}
 
 InternedString StringInterner::const_iterator::operator*() const {
-  if (!interner || index >= interner->Storage.size()) {
+  if (!interner || id == Symbol::kInvalidID) {
     return InternedString();
   }
-
-  auto it = interner->Storage.begin();
-  std::advance(it, index);
-  return InternedString((*it)->c_str());
+  return InternedString(interner->getSymbolData(id));
 }
 
 StringInterner::const_iterator &StringInterner::const_iterator::operator++() {
-  ++index;
+  ++id;
+  settle();
   return *this;
 }
 
 StringInterner::const_iterator StringInterner::const_iterator::operator++(int) {
   const_iterator tmp = *this;
-  ++index;
+  ++*this;
   return tmp;
 }
 
 bool StringInterner::const_iterator::operator==(
     const const_iterator &other) const {
-  return interner == other.interner && index == other.index;
+  return interner == other.interner && id == other.id;
 }
 
 bool StringInterner::const_iterator::operator!=(
@@ -337,40 +823,17 @@ bool StringInterner::const_iterator::operator!=(
 }
 
 StringInterner::const_iterator StringInterner::begin() const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
-  return const_iterator(this, 0);
+  // ID 0 is the empty string, which is never stored; IDs below
+  // firstSymbol belong to the base layer
+  return const_iterator(this, firstSymbol);
 }
 
 StringInterner::const_iterator StringInterner::end() const {
-  std::shared_lock<std::shared_mutex> lock(Mutex);
-  return const_iterator(this, Storage.size());
+  return const_iterator(this, Symbol::kInvalidID);
 }
 
 const char *StringInterner::findOrCreateString(std::string_view str) {
   return intern(str).toCStr();
 }
 
-// Hash and equality functions for StringStorage
-size_t StringInterner::StringStorageHash::operator()(
-    const std::unique_ptr<StringStorage> &storage) const {
-  if (!storage || !storage->data)
-    return 0;
-
-  // Use std::hash for string_view
-  return std::hash<std::string_view>{}(
-      std::string_view(storage->c_str(), storage->size));
-}
-
-bool StringInterner::StringStorageEqual::operator()(
-    const std::unique_ptr<StringStorage> &lhs,
-    const std::unique_ptr<StringStorage> &rhs) const {
-  if (!lhs || !rhs || !lhs->data || !rhs->data)
-    return lhs == rhs;
-  if (lhs->size != rhs->size)
-    return false;
-
-  // Use SIMD-optimized comparison for better performance
-  return fast_string_equal(lhs->data, rhs->data, lhs->size);
-}
-
 } // namespace ml
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "ml/Managers/DiagnosticManager.hpp"
+#include "ml/Basic/ArenaProfiler.hpp"
 #include "ml/Managers/SourceManager.hpp"
 #include <algorithm>
 #include <iomanip>
@@ -22,7 +23,7 @@ const DiagnosticInfo DiagnosticManager::sDiagnosticInfos[] = {
 DiagnosticManager::DiagnosticManager(StringInterner &interner)
     : interner(interner) {}
 
-DiagnosticManager::~DiagnosticManager() = default;
+DiagnosticManager::~DiagnosticManager() { setMemoryBudget(nullptr); }
 
 DiagnosticManager::DiagnosticManager(DiagnosticManager &&other) noexcept
     : interner(other.interner), srcMgr(other.srcMgr),
@@ -30,7 +31,30 @@ DiagnosticManager::DiagnosticManager(DiagnosticManager &&other) noexcept
       suppressWarnings(other.suppressWarnings),
       suppressNotes(other.suppressNotes),
       warningsAsErrors(other.warningsAsErrors), maxErrors(other.maxErrors),
-      stats(other.stats) {}
+      stats(other.stats) {
+  // The overflow handler reports to its manager, so point it at this one
+  MemoryBudget *budget = other.memoryBudget;
+  other.memoryBudget = nullptr;
+  setMemoryBudget(budget);
+}
+
+void DiagnosticManager::setMemoryBudget(MemoryBudget *budget) {
+  if (memoryBudget) {
+    memoryBudget->setOverflowHandler({});
+  }
+
+  memoryBudget = budget;
+  if (memoryBudget) {
+    memoryBudget->setOverflowHandler([this](const MemoryBudget::Client &client,
+                                            size_t used, size_t limit) {
+      Diagnostic diag(DiagnosticID::MemoryOverflowError);
+      diag.addArg(client.getName())
+          .addArg(std::to_string(used))
+          .addArg(std::to_string(limit));
+      report(diag);
+    });
+  }
+}
 
 void DiagnosticManager::addConsumer(
     std::unique_ptr<DiagnosticConsumer> consumer) {
@@ -40,6 +64,8 @@ void DiagnosticManager::addConsumer(
 void DiagnosticManager::clearConsumers() { consumers.clear(); }
 
 void DiagnosticManager::report(const Diagnostic &diag) {
+  ML_ARENA_PROFILE_SCOPE(Diagnostics);
+
   const DiagnosticInfo &info = getDiagnosticInfo(diag.getID());
 
   // Check if we should suppress this diagnostic
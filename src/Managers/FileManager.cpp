@@ -1,4 +1,5 @@
 #include "ml/Managers/FileManager.hpp"
+#include "ml/Basic/ArenaProfiler.hpp"
 #include <algorithm>
 #include <chrono>
 #include <cstring>
@@ -18,15 +19,27 @@
 
 namespace ml {
 
+// The bytes a cached file holds, including its null terminator
+static size_t getCachedSize(const FileEntry &entry) {
+  return entry.getSize() + 1;
+}
+
 FileManager::FileManager(StringInterner &interner) : interner(interner) {}
 
-FileManager::~FileManager() { clearCache(); }
+FileManager::~FileManager() {
+  clearCache();
+  setMemoryBudget(nullptr);
+}
 
 FileManager::FileManager(FileManager &&other) noexcept
     : fileCache(std::move(other.fileCache)), interner(other.interner),
       maxCacheSize(other.maxCacheSize),
       memoryMappingEnabled(other.memoryMappingEnabled),
       memoryMappingThreshold(other.memoryMappingThreshold), stats(other.stats) {
+  // The eviction callback is bound to the manager, so register anew
+  MemoryBudget *otherBudget = other.budget;
+  other.setMemoryBudget(nullptr);
+  setMemoryBudget(otherBudget);
 }
 
 FileManager &FileManager::operator=(FileManager &&other) noexcept {
@@ -37,6 +50,10 @@ FileManager &FileManager::operator=(FileManager &&other) noexcept {
     memoryMappingEnabled = other.memoryMappingEnabled;
     memoryMappingThreshold = other.memoryMappingThreshold;
     stats = other.stats;
+
+    MemoryBudget *otherBudget = other.budget;
+    other.setMemoryBudget(nullptr);
+    setMemoryBudget(otherBudget);
   }
   return *this;
 }
@@ -48,6 +65,8 @@ std::shared_ptr<FileEntry> FileManager::getFile(const std::string &filename) {
 
 std::pair<std::shared_ptr<FileEntry>, std::error_code>
 FileManager::getFileWithError(const std::string &filename) {
+  ML_ARENA_PROFILE_SCOPE(FileCache);
+
   std::string normalizedName = normalizeFilename(filename);
   InternedString internedName = interner.intern(normalizedName);
 
@@ -70,6 +89,15 @@ FileManager::getFileWithError(const std::string &filename) {
     return {nullptr, error};
   }
 
+  // Charge before caching and without the lock, since the budget may call
+  // back into evictForBudget()
+  size_t cachedSize = getCachedSize(*entry);
+  if (budget && !budget->charge(budgetClient, cachedSize)) {
+    // Still over budget after eviction; serve the file without caching it
+    budget->release(budgetClient, cachedSize);
+    return {entry, {}};
+  }
+
   {
     std::lock_guard<std::mutex> lock(cacheMutex);
 
@@ -77,6 +105,9 @@ FileManager::getFileWithError(const std::string &filename) {
     auto it = fileCache.find(internedName);
     if (it != fileCache.end()) {
       ++stats.cacheHitCount;
+      if (budget) {
+        budget->release(budgetClient, cachedSize);
+      }
       return {it->second, {}};
     }
 
@@ -155,7 +186,9 @@ FileManager::getFileModTime(const std::string &filename) const {
 
 void FileManager::clearCache() {
   std::lock_guard<std::mutex> lock(cacheMutex);
-  fileCache.clear();
+  while (!fileCache.empty()) {
+    eraseFromCache(fileCache.begin());
+  }
   stats.fileCacheCount = 0;
 }
 
@@ -166,11 +199,36 @@ void FileManager::removeFromCache(const std::string &filename) {
 
   auto it = fileCache.find(internedName);
   if (it != fileCache.end()) {
-    fileCache.erase(it);
+    eraseFromCache(it);
     --stats.fileCacheCount;
   }
 }
 
+void FileManager::setMemoryBudget(MemoryBudget *newBudget) {
+  if (budget) {
+    budget->unregisterClient(budgetClient);
+  }
+
+  budget = newBudget;
+  budgetClient = nullptr;
+  if (!budget) {
+    return;
+  }
+
+  budgetClient = budget->registerClient(
+      "file_cache", [this](size_t bytes) { return evictForBudget(bytes); });
+
+  // Charge what is already cached
+  size_t cachedBytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(cacheMutex);
+    for (const auto &[filename, entry] : fileCache) {
+      cachedBytes += getCachedSize(*entry);
+    }
+  }
+  budget->charge(budgetClient, cachedBytes);
+}
+
 size_t FileManager::getCurrentCacheSize() const {
   std::lock_guard<std::mutex> lock(cacheMutex);
 
@@ -265,11 +323,37 @@ void FileManager::evictIfNeeded() {
   auto it = fileCache.begin();
   while (it != fileCache.end() && currentSize > maxCacheSize) {
     currentSize -= it->second->getSize();
-    it = fileCache.erase(it);
+    it = eraseFromCache(it);
     --stats.fileCacheCount;
   }
 }
 
+size_t FileManager::evictForBudget(size_t bytes) {
+  std::lock_guard<std::mutex> lock(cacheMutex);
+
+  // Only entries nobody else holds free memory when evicted
+  size_t freed = 0;
+  auto it = fileCache.begin();
+  while (it != fileCache.end() && freed < bytes) {
+    if (it->second.use_count() > 1) {
+      ++it;
+      continue;
+    }
+    freed += getCachedSize(*it->second);
+    it = eraseFromCache(it);
+    --stats.fileCacheCount;
+  }
+  return freed;
+}
+
+FileManager::FileCache::iterator
+FileManager::eraseFromCache(FileCache::iterator it) {
+  if (budget) {
+    budget->release(budgetClient, getCachedSize(*it->second));
+  }
+  return fileCache.erase(it);
+}
+
 std::string FileManager::normalizeFilename(const std::string &filename) const {
   std::error_code ec;
   auto canonical = std::filesystem::canonical(filename, ec);
@@ -81,12 +81,16 @@ SourceManager::SourceManager(FileManager &fileMgr) : fileMgr(fileMgr) {
   g_location_cache.invalidate();
 }
 
-SourceManager::~SourceManager() = default;
+SourceManager::~SourceManager() { setMemoryBudget(nullptr); }
 
 SourceManager::SourceManager(SourceManager &&other) noexcept
     : fileMgr(other.fileMgr), loadedFiles(std::move(other.loadedFiles)),
       filenameToFileID(std::move(other.filenameToFileID)),
-      nextLocationID(other.nextLocationID.load()), stats(other.stats) {}
+      nextLocationID(other.nextLocationID.load()), stats(other.stats),
+      budget(other.budget), budgetClient(other.budgetClient) {
+  other.budget = nullptr;
+  other.budgetClient = nullptr;
+}
 
 SourceManager &SourceManager::operator=(SourceManager &&other) noexcept {
   if (this != &other) {
@@ -94,6 +98,12 @@ SourceManager &SourceManager::operator=(SourceManager &&other) noexcept {
     filenameToFileID = std::move(other.filenameToFileID);
     nextLocationID = other.nextLocationID.load();
     stats = other.stats;
+
+    setMemoryBudget(nullptr);
+    budget = other.budget;
+    budgetClient = other.budgetClient;
+    other.budget = nullptr;
+    other.budgetClient = nullptr;
   }
   return *this;
 }
@@ -532,11 +542,37 @@ void SourceManager::clearCache() {
 
   // Clear line offset caches
   for (auto &info : loadedFiles) {
-    info.lineOffsets.clear();
+    if (budget) {
+      budget->release(budgetClient,
+                      info.lineOffsets.capacity() * sizeof(uint32_t));
+    }
+    info.lineOffsets = std::vector<uint32_t>();
     info.lineOffsetsComputed = false;
   }
 }
 
+void SourceManager::setMemoryBudget(MemoryBudget *newBudget) {
+  if (budget) {
+    budget->unregisterClient(budgetClient);
+  }
+
+  budget = newBudget;
+  budgetClient = budget ? budget->registerClient("source_manager") : nullptr;
+  if (!budget) {
+    return;
+  }
+
+  // Charge the line tables computed so far
+  size_t tableBytes = 0;
+  {
+    std::lock_guard<std::mutex> lock(stateMutex);
+    for (const auto &info : loadedFiles) {
+      tableBytes += info.lineOffsets.capacity() * sizeof(uint32_t);
+    }
+  }
+  budget->charge(budgetClient, tableBytes);
+}
+
 void SourceManager::computeLineOffsets(FileID fid) const {
   if (fid.isInvalid() || fid.get() == 0 || fid.get() > loadedFiles.size()) {
     return;
@@ -653,6 +689,10 @@ void SourceManager::computeLineOffsets(FileID fid) const {
 #endif
 
   info.lineOffsetsComputed = true;
+  if (budget) {
+    budget->charge(budgetClient,
+                   info.lineOffsets.capacity() * sizeof(uint32_t));
+  }
 }
 
 uint32_t SourceManager::findLineNumber(const std::vector<uint32_t> &lineOffsets,
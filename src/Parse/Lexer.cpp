@@ -1,11 +1,16 @@
 #include "ml/Parse/Lexer.hpp"
+#include "ml/Basic/ArenaProfiler.hpp"
 #include "ml/Managers/SourceManager.hpp"
 #include <algorithm>
+#include <atomic>
 #include <cctype>
 #include <chrono>
 #include <cstring>
+#include <exception>
 #include <iostream>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #ifdef _MSC_VER
 #include <immintrin.h>
@@ -189,8 +194,8 @@ static TokenKind getKeywordKindFast(std::string_view text) {
 Lexer::Lexer(const SourceManager &srcMgr, FileID fileID,
              StringInterner &interner, DiagnosticManager &diagMgr,
              const LexerOptions &opts)
-    : srcMgr(&srcMgr), fid(fileID), interner(interner), diagMgr(diagMgr),
-      options(opts), currentLine(1),
+    : srcMgr(&srcMgr), fid(fileID), interner(interner), internCache(interner),
+      diagMgr(diagMgr), options(opts), currentLine(1),
       baseLocation(srcMgr.getLocForStartOfFile(fileID)) {
 
   const FileEntry *entry = srcMgr.getFileEntry(fileID);
@@ -207,7 +212,8 @@ Lexer::Lexer(const SourceManager &srcMgr, FileID fileID,
 Lexer::Lexer(std::string_view source, StringInterner &interner,
              DiagnosticManager &diagMgr, const LexerOptions &opts)
     : srcMgr(nullptr), fid(FileID::getInvalid()), interner(interner),
-      diagMgr(diagMgr), options(opts), source(source), currentLine(1),
+      internCache(interner), diagMgr(diagMgr), options(opts), source(source),
+      currentLine(1),
       baseLocation(SourceLocation::getInvalidLoc()) {
 
   current = source.data();
@@ -219,6 +225,7 @@ Lexer::~Lexer() = default;
 
 Lexer::Lexer(Lexer &&other) noexcept
     : srcMgr(other.srcMgr), fid(other.fid), interner(other.interner),
+      internCache(other.internCache), localTable(other.localTable),
       diagMgr(other.diagMgr), options(other.options),
       ppCallback(std::move(other.ppCallback)), source(other.source),
       current(other.current), end(other.end), lineStart(other.lineStart),
@@ -230,6 +237,8 @@ Lexer::Lexer(Lexer &&other) noexcept
 }
 
 Token Lexer::nextToken() {
+  ML_ARENA_PROFILE_SCOPE(Lexer);
+
   // If we have a peeked token, return it
   if (hasPeekedToken) {
     hasPeekedToken = false;
@@ -391,6 +400,36 @@ Token Lexer::nextToken() {
   return token;
 }
 
+size_t Lexer::nextTokens(std::vector<Token> &tokens, size_t maxTokens) {
+  size_t first = tokens.size();
+  pendingTexts.clear();
+  pendingTokens.clear();
+
+  deferInterning = true;
+  while (tokens.size() - first < maxTokens) {
+    size_t pending = pendingTexts.size();
+    Token token = nextToken();
+    if (pendingTexts.size() != pending) {
+      pendingTokens.push_back(tokens.size());
+    }
+    tokens.push_back(token);
+    if (token.getKind() == TokenKind::EndOfFile) {
+      break;
+    }
+  }
+  deferInterning = false;
+
+  if (!pendingTexts.empty()) {
+    std::vector<InternedString> interned(pendingTexts.size());
+    interner.internBatch(pendingTexts, interned);
+    for (size_t i = 0; i < pendingTokens.size(); ++i) {
+      tokens[pendingTokens[i]].setSymbol(interned[i].getSymbol());
+      internCache.insert(interned[i]);
+    }
+  }
+  return tokens.size() - first;
+}
+
 const Token &Lexer::peekToken() {
   if (!hasPeekedToken) {
     peekedToken = std::make_unique<Token>(nextToken());
@@ -612,6 +651,33 @@ Token Lexer::makeToken(TokenKind kind, const char *start,
   return Token(kind, loc, length);
 }
 
+void Lexer::internText(Token &token, std::string_view text) {
+  // A private table needs neither the cache nor a batch
+  if (localTable) {
+    token.setSymbol(Symbol(localTable->intern(text)));
+    return;
+  }
+
+  // Most text repeats within a file; the cache answers it without
+  // touching the shared interner
+  InternedString cached = internCache.lookup(text);
+  if (cached.isValid()) {
+    ++stats.internCacheHits;
+    token.setSymbol(cached.getSymbol());
+    return;
+  }
+  ++stats.internCacheMisses;
+
+  // nextTokens() resolves the whole block at once
+  if (deferInterning) {
+    pendingTexts.push_back(text);
+    return;
+  }
+  InternedString str = interner.intern(text);
+  internCache.insert(str);
+  token.setSymbol(str.getSymbol());
+}
+
 Token Lexer::makeIdentifierToken(const char *start, const char *end) {
   std::string_view text(start, end - start);
 
@@ -621,7 +687,7 @@ Token Lexer::makeIdentifierToken(const char *start, const char *end) {
   Token token = makeToken(kind, start, end);
 
   if (kind == TokenKind::Identifier) {
-    token.setText(interner.intern(text));
+    internText(token, text);
     ++stats.identifierCount;
   } else {
     token.addFlag(TokenFlags::IsKeyword);
@@ -739,7 +805,7 @@ Token Lexer::lexNumber() {
 
   std::string_view text(start, current - start);
   Token token = makeToken(kind, start, current);
-  token.setText(interner.intern(text));
+  internText(token, text);
 
   ++stats.literalCount;
   return token;
@@ -836,7 +902,7 @@ Token Lexer::lexString(char quote) {
     token.addFlag(TokenFlags::NeedsCleaning);
   }
 
-  token.setText(interner.intern(text));
+  internText(token, text);
 
   ++stats.literalCount;
   return token;
@@ -932,7 +998,7 @@ Token Lexer::lexCharLiteral() {
     token.addFlag(TokenFlags::NeedsCleaning);
   }
 
-  token.setText(interner.intern(text));
+  internText(token, text);
 
   ++stats.literalCount;
   return token;
@@ -1333,6 +1399,8 @@ void Lexer::printStats(std::ostream &os) const {
   os << "  SIMD Operations: " << stats.simdOperations << "\n";
   os << "  Lookup Table Hits: " << stats.lookupTableHits << "\n";
   os << "  Branch Misses: " << stats.branchMisses << "\n";
+  os << "  Intern Cache Hits: " << stats.internCacheHits << "\n";
+  os << "  Intern Cache Misses: " << stats.internCacheMisses << "\n";
   os << "  Average Time per Token (micros): "
      << (stats.tokenCount > 0 ? (stats.lexingTimeMs * 1000.0) / stats.tokenCount
                               : 0.0)
@@ -1493,6 +1561,15 @@ void TokenManager::printTokens(std::ostream &os) const {
   }
 }
 
+void TokenManager::printTokens(std::ostream &os,
+                               const StringInterner &interner) const {
+  for (size_t i = 0; i < tokens.size(); ++i) {
+    os << i << ": ";
+    printToken(os, tokens[i], interner);
+    os << "\n";
+  }
+}
+
 size_t TokenManager::getMemoryUsage() const {
   return tokens.size() * sizeof(Token) + locationIndex.size() * sizeof(size_t);
 }
@@ -1503,6 +1580,9 @@ void TokenManager::buildLocationIndex() const {
   locationIndexValid = true;
 }
 
+// Tokens lexed between batched interner visits
+static constexpr size_t kTokenBlockSize = 512;
+
 // Convenience functions
 std::vector<Token> tokenizeString(std::string_view source,
                                   StringInterner &interner,
@@ -1515,11 +1595,9 @@ std::vector<Token> tokenizeString(std::string_view source,
   // Typical token density: ~1 token per 6-8 characters
   tokens.reserve(source.size() / 7 + 64);
 
-  Token token;
   do {
-    token = lexer.nextToken();
-    tokens.push_back(token);
-  } while (token.getKind() != TokenKind::EndOfFile);
+    lexer.nextTokens(tokens, kTokenBlockSize);
+  } while (tokens.back().getKind() != TokenKind::EndOfFile);
 
   return tokens;
 }
@@ -1540,11 +1618,9 @@ std::vector<Token> tokenizeFile(const SourceManager &srcMgr, FileID fileID,
     tokens.reserve(1024);
   }
 
-  Token token;
   do {
-    token = lexer.nextToken();
-    tokens.push_back(token);
-  } while (token.getKind() != TokenKind::EndOfFile);
+    lexer.nextTokens(tokens, kTokenBlockSize);
+  } while (tokens.back().getKind() != TokenKind::EndOfFile);
 
   return tokens;
 }
@@ -1555,17 +1631,135 @@ BatchTokenizer::BatchTokenizer(StringInterner &interner,
                                const LexerOptions &opts)
     : interner(interner), diagMgr(diagMgr), options(opts) {}
 
+namespace {
+
+// Holds a file's diagnostics until they can be reported in file order
+class BufferedDiagnosticConsumer : public DiagnosticConsumer {
+public:
+  void handleDiagnostic(const Diagnostic &diag, const DiagnosticInfo &,
+                        const SourceManager *) override {
+    diagnostics.push_back(diag);
+  }
+
+  std::vector<Diagnostic> diagnostics;
+};
+
+// Runs job(i) for every i below count across the hardware threads. The
+// first exception thrown stops the remaining jobs and is rethrown here.
+template <typename Job> void runParallel(size_t count, const Job &job) {
+  std::atomic<size_t> next{0};
+  std::exception_ptr failure;
+  std::mutex failureMutex;
+  auto work = [&] {
+    try {
+      for (size_t i = next++; i < count; i = next++) {
+        job(i);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(failureMutex);
+      if (!failure) {
+        failure = std::current_exception();
+      }
+      next = count;
+    }
+  };
+
+  size_t threadCount = std::min<size_t>(
+      count, std::max(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < threadCount; ++t) {
+    threads.emplace_back(work);
+  }
+  work();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+} // namespace
+
 std::vector<std::vector<Token>>
 BatchTokenizer::tokenizeParallel(const std::vector<std::string_view> &sources) {
+  struct FileResult {
+    LocalStringTable table;
+    std::vector<Symbol> remap;
+    std::vector<std::string_view> misses;
+    std::vector<uint32_t> missIDs;
+    std::vector<Diagnostic> diagnostics;
+    LexerStats stats;
+  };
+  std::vector<std::vector<Token>> results(sources.size());
+  std::vector<FileResult> files(sources.size());
+
+  // Lex. Each file numbers its text in a private table and buffers its
+  // diagnostics, so the threads share nothing and take no locks.
+  runParallel(sources.size(), [&](size_t i) {
+    FileResult &file = files[i];
+    DiagnosticManager localDiags(interner);
+    auto buffer = std::make_unique<BufferedDiagnosticConsumer>();
+    BufferedDiagnosticConsumer *consumer = buffer.get();
+    localDiags.addConsumer(std::move(buffer));
+
+    Lexer lexer(sources[i], interner, localDiags, options);
+    lexer.setLocalTable(&file.table);
+    std::vector<Token> &tokens = results[i];
+    tokens.reserve(sources[i].size() / 7 + 64);
+    do {
+      lexer.nextTokens(tokens, kTokenBlockSize);
+    } while (tokens.back().getKind() != TokenKind::EndOfFile);
+
+    file.stats = lexer.getStats();
+    file.diagnostics = std::move(consumer->diagnostics);
+  });
+
+  // Resolve the strings the interner already holds. Nothing is interned
+  // in this phase, so the files are looked up in parallel.
+  runParallel(sources.size(), [&](size_t i) {
+    FileResult &file = files[i];
+    std::span<const std::string_view> strs = file.table.getStrings();
+    file.remap.assign(file.table.getSymbolCount(), Symbol());
+    file.remap[0] = Symbol(0); // The empty string is the same everywhere
+    for (size_t k = 0; k < strs.size(); ++k) {
+      InternedString str = interner.lookup(strs[k]);
+      if (str.isValid()) {
+        file.remap[k + 1] = str.getSymbol();
+      } else {
+        file.misses.push_back(strs[k]);
+        file.missIDs.push_back(static_cast<uint32_t>(k + 1));
+      }
+    }
+  });
+
+  // Intern the rest in file order. A table numbers its strings by first
+  // occurrence, so the new ones get exactly the symbols lexing the files
+  // one after another would have given them.
+  std::vector<InternedString> merged;
+  for (FileResult &file : files) {
+    merged.assign(file.misses.size(), InternedString());
+    interner.internBatch(file.misses, merged);
+    for (size_t k = 0; k < merged.size(); ++k) {
+      file.remap[file.missIDs[k]] = merged[k].getSymbol();
+    }
+  }
 
-  std::vector<std::vector<Token>> results;
-  results.reserve(sources.size());
+  // Rewrite each file's token symbols in one pass
+  runParallel(sources.size(), [&](size_t i) {
+    const std::vector<Symbol> &remap = files[i].remap;
+    for (Token &token : results[i]) {
+      if (token.getSymbol().isValid()) {
+        token.setSymbol(remap[token.getSymbol().getID()]);
+      }
+    }
+  });
 
-  // For now, implement serial processing
-  // TODO: Add parallel processing with thread pool
-  for (const auto &source : sources) {
-    auto tokens = tokenizeString(source, interner, diagMgr, options);
-    results.push_back(std::move(tokens));
+  for (const FileResult &file : files) {
+    for (const Diagnostic &diag : file.diagnostics) {
+      diagMgr.report(diag);
+    }
+    addStats(file.stats);
   }
 
   return results;
@@ -1575,14 +1769,22 @@ void BatchTokenizer::tokenizeStreaming(
     std::string_view source, std::function<void(const Token &)> callback) {
   Lexer lexer(source, interner, diagMgr, options);
 
-  Token token;
+  // Lex a block, intern its text in one batch, then hand it out
+  std::vector<Token> block;
+  block.reserve(kTokenBlockSize);
   do {
-    token = lexer.nextToken();
-    callback(token);
-  } while (token.getKind() != TokenKind::EndOfFile);
+    block.clear();
+    lexer.nextTokens(block, kTokenBlockSize);
+    for (const Token &token : block) {
+      callback(token);
+    }
+  } while (block.back().getKind() != TokenKind::EndOfFile);
 
   // Update aggregate statistics
-  LexerStats stats = lexer.getStats();
+  addStats(lexer.getStats());
+}
+
+void BatchTokenizer::addStats(const LexerStats &stats) {
   aggregateStats.tokenCount += stats.tokenCount;
   aggregateStats.identifierCount += stats.identifierCount;
   aggregateStats.keywordCount += stats.keywordCount;
@@ -1594,6 +1796,8 @@ void BatchTokenizer::tokenizeStreaming(
   aggregateStats.simdOperations += stats.simdOperations;
   aggregateStats.lookupTableHits += stats.lookupTableHits;
   aggregateStats.branchMisses += stats.branchMisses;
+  aggregateStats.internCacheHits += stats.internCacheHits;
+  aggregateStats.internCacheMisses += stats.internCacheMisses;
   aggregateStats.updateAverages();
 }
 
@@ -409,10 +409,21 @@ std::ostream &operator<<(std::ostream &os, TokenKind kind) {
 
 std::ostream &operator<<(std::ostream &os, const Token &token) {
   os << TokenInfo::getTokenName(token.getKind());
-  if (token.getText().isValid()) {
-    os << "(" << token.getText().toStringView() << ")";
+  if (token.getSymbol().isValid()) {
+    os << "(#" << token.getSymbol().getID() << ")";
   }
   return os;
 }
 
+void printToken(std::ostream &os, const Token &token,
+                const StringInterner &interner) {
+  os << TokenInfo::getTokenName(token.getKind());
+  InternedString text = interner.getString(token.getSymbol());
+  if (text.isValid()) {
+    os << "(" << text.toStringView() << ")";
+  } else if (token.getSymbol().isValid()) {
+    os << "(#" << token.getSymbol().getID() << ")";
+  }
+}
+
 } // namespace ml
\ No newline at end of file
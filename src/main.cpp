@@ -1,22 +1,38 @@
 #include "ml/Basic/ArenaAllocator.hpp"
+#include "ml/Basic/ArenaProfiler.hpp"
+#include "ml/Basic/MemoryBudget.hpp"
 #include "ml/Basic/StringInterner.hpp"
 #include "ml/Managers/DiagnosticManager.hpp"
 #include "ml/Managers/FileManager.hpp"
 #include "ml/Managers/SourceManager.hpp"
 #include "ml/Parse/Lexer.hpp"
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <vector>
 
 int main(int argc, char **argv) {
+  // One limit shared by every subsystem; unlimited unless ML_MEMORY_LIMIT is
+  // set to a byte count
+  ml::MemoryBudget budget;
+  if (const char *limit = std::getenv("ML_MEMORY_LIMIT")) {
+    budget.setLimit(std::strtoull(limit, nullptr, 10));
+  }
+
   // Create arena allocator for efficient memory management
   ml::ArenaAllocator arena(2 * 1024 * 1024); // 12MB chunks
+  arena.setMemoryBudget(&budget);
 
   // Use arena-backed string interner for better memory locality
   ml::StringInterner interner(arena);
+  interner.setMemoryBudget(&budget);
   ml::FileManager fileMgr(interner);
+  fileMgr.setMemoryBudget(&budget);
+  ml::DiagnosticManager diagMgr(interner);
+  diagMgr.setMemoryBudget(&budget);
   auto file = fileMgr.getFile(argv[1]);
   ml::SourceManager srcMgr(fileMgr);
-  ml::DiagnosticManager diagMgr(interner);
+  srcMgr.setMemoryBudget(&budget);
   diagMgr.setSourceManager(
       &srcMgr); // Set the SourceManager for proper location reporting
   diagMgr.addConsumer(std::make_unique<ml::TextDiagnosticConsumer>(std::cout));
@@ -41,5 +57,12 @@ int main(int argc, char **argv) {
 
   std::cout << "\n";
   arena.printStats(std::cout);
+  budget.printStats(std::cout);
+
+#ifdef ML_ARENA_PROFILING
+  // Render with flamegraph.pl or any folded-stack viewer
+  std::ofstream profile("arena-profile.folded");
+  arena.getStatsPolicy().writeFoldedStacks(profile);
+#endif
   return 0;
 }
@@ -0,0 +1,338 @@
+#include "ml/Basic/ArenaAllocator.hpp"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <sstream>
+#include <string>
+#include <vector>
+
+class ArenaAllocatorTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(ArenaAllocatorTest, ScopeReleasesAllocations) {
+  ml::ArenaAllocator arena(4096);
+  void *before = arena.allocate(64);
+  size_t usedBefore = arena.getTotalUsed();
+
+  {
+    ml::ArenaScope scope(arena);
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_NE(arena.allocate(128), nullptr);
+    }
+    EXPECT_GT(arena.getTotalUsed(), usedBefore);
+  }
+
+  // Everything allocated inside the scope is released
+  EXPECT_EQ(arena.getTotalUsed(), usedBefore);
+  EXPECT_EQ(arena.getStats().currentUsage, usedBefore);
+  EXPECT_TRUE(arena.contains(before));
+}
+
+TEST_F(ArenaAllocatorTest, RewindKeepsChunksForReuse) {
+  ml::ArenaAllocator arena(4096);
+  ml::ArenaMarker marker = arena.getMarker();
+
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(256);
+  }
+  size_t chunkCount = arena.getStats().chunkCount;
+  size_t totalAllocated = arena.getTotalAllocated();
+  EXPECT_GT(chunkCount, 1u);
+
+  arena.rewind(marker);
+  EXPECT_EQ(arena.getTotalUsed(), 0u);
+  EXPECT_EQ(arena.getTotalAllocated(), totalAllocated);
+
+  // Reallocating the same amount reuses the retained chunks
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(256);
+  }
+  EXPECT_EQ(arena.getStats().chunkCount, chunkCount);
+  EXPECT_EQ(arena.getTotalAllocated(), totalAllocated);
+}
+
+TEST_F(ArenaAllocatorTest, NestedScopes) {
+  ml::ArenaAllocator arena(4096);
+  {
+    ml::ArenaScope outer(arena);
+    void *outerPtr = arena.allocate(32);
+    size_t outerUsed = arena.getTotalUsed();
+    {
+      ml::ArenaScope inner(arena);
+      arena.allocate(8192 - 64);
+    }
+    EXPECT_EQ(arena.getTotalUsed(), outerUsed);
+    EXPECT_TRUE(arena.contains(outerPtr));
+  }
+  EXPECT_EQ(arena.getTotalUsed(), 0u);
+  EXPECT_GE(arena.getStats().peakUsage, 8192u - 64u);
+}
+
+TEST_F(ArenaAllocatorTest, ResetRetainsChunks) {
+  ml::ArenaAllocator arena(4096);
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(256);
+  }
+  size_t totalAllocated = arena.getTotalAllocated();
+  size_t chunkCount = arena.getStats().chunkCount;
+
+  arena.reset();
+  ml::ArenaStats stats = arena.getStats();
+  EXPECT_EQ(stats.allocatedCount, totalAllocated);
+  EXPECT_EQ(stats.chunkCount, chunkCount);
+  EXPECT_EQ(stats.currentUsage, 0u);
+  EXPECT_EQ(stats.allocationCount, 0u);
+  EXPECT_EQ(stats.activeByteCount, 4096u);
+  EXPECT_EQ(stats.retainedByteCount, totalAllocated - 4096u);
+
+  // No new chunks are needed after warm-up
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(256);
+  }
+  EXPECT_EQ(arena.getStats().chunkCount, chunkCount);
+  EXPECT_EQ(arena.getStats().retainedByteCount, 0u);
+}
+
+TEST_F(ArenaAllocatorTest, ResetHonoursRetentionLimit) {
+  ml::ArenaAllocator arena(4096);
+  arena.setMaxRetainedBytes(2 * 4096);
+  for (int i = 0; i < 100; ++i) {
+    arena.allocate(256);
+  }
+
+  arena.reset();
+  EXPECT_EQ(arena.getTotalAllocated(), 2u * 4096u);
+  EXPECT_EQ(arena.getStats().chunkCount, 2u);
+
+  // The first chunk is always kept
+  arena.setMaxRetainedBytes(0);
+  arena.reset();
+  EXPECT_EQ(arena.getTotalAllocated(), 4096u);
+  EXPECT_NE(arena.allocate(16), nullptr);
+}
+
+TEST_F(ArenaAllocatorTest, ClearKeepsStatsConsistent) {
+  ml::ArenaAllocator arena(4096);
+  for (int i = 0; i < 10; ++i) {
+    arena.allocate(100);
+  }
+  size_t peak = arena.getStats().peakUsage;
+
+  arena.clear();
+  ml::ArenaStats stats = arena.getStats();
+  EXPECT_EQ(stats.currentUsage, 0u);
+  EXPECT_EQ(stats.requestedCount, 0u);
+  EXPECT_EQ(stats.allocationCount, 0u);
+  EXPECT_EQ(stats.wastedByteCount, 0u);
+  EXPECT_EQ(stats.peakUsage, peak);
+  EXPECT_EQ(arena.getTotalUsed(), 0u);
+}
+
+TEST_F(ArenaAllocatorTest, VirtualMemoryBackendCommitsOnDemand) {
+  ml::ArenaAllocator arena(ml::ArenaAllocator::kDefaultChunkSize,
+                           ml::ArenaBackend::VirtualMemory);
+  EXPECT_EQ(arena.getTotalAllocated(), 0u);
+
+  std::vector<char *> ptrs;
+  for (int i = 0; i < 64; ++i) {
+    char *ptr = static_cast<char *>(arena.allocate(256 * 1024));
+    ASSERT_NE(ptr, nullptr);
+    std::memset(ptr, i, 256 * 1024);
+    ptrs.push_back(ptr);
+  }
+
+  // Everything lives in one contiguous reservation without chunk waste
+  ml::ArenaStats stats = arena.getStats();
+  EXPECT_EQ(stats.chunkCount, 1u);
+  EXPECT_EQ(stats.wastedByteCount, 0u);
+  EXPECT_GE(arena.getTotalAllocated(), 64u * 256u * 1024u);
+  EXPECT_EQ(arena.getTotalAllocated() %
+                ml::ArenaAllocator::kCommitGranularity,
+            0u);
+  for (char *ptr : ptrs) {
+    EXPECT_TRUE(arena.contains(ptr));
+  }
+
+  // Reset decommits pages beyond the retention limit
+  arena.setMaxRetainedBytes(ml::ArenaAllocator::kCommitGranularity);
+  arena.reset();
+  EXPECT_EQ(arena.getTotalAllocated(),
+            ml::ArenaAllocator::kCommitGranularity);
+  EXPECT_NE(arena.allocate(512 * 1024), nullptr);
+}
+
+namespace {
+
+struct Tracked {
+  explicit Tracked(std::vector<int> &log, int id) : log(log), id(id) {}
+  ~Tracked() { log.push_back(id); }
+
+  std::vector<int> &log;
+  int id;
+  std::string payload = "heap-owning member";
+};
+
+} // namespace
+
+TEST_F(ArenaAllocatorTest, DestructorsRunOnReset) {
+  std::vector<int> log;
+  ml::ArenaAllocator arena(4096);
+
+  for (int i = 0; i < 3; ++i) {
+    arena.allocate<Tracked>(log, i);
+  }
+  arena.allocate<int>(42);
+  EXPECT_EQ(arena.getStats().pendingDestructorCount, 3u);
+
+  arena.reset();
+  EXPECT_EQ(log, (std::vector<int>{2, 1, 0}));
+  EXPECT_EQ(arena.getStats().pendingDestructorCount, 0u);
+}
+
+TEST_F(ArenaAllocatorTest, DestructorsRunOnRewindAndDestruction) {
+  std::vector<int> log;
+  {
+    ml::ArenaAllocator arena(4096);
+    arena.allocate<Tracked>(log, 0);
+    {
+      ml::ArenaScope scope(arena);
+      arena.allocate<Tracked>(log, 1);
+      arena.allocate<Tracked>(log, 2);
+    }
+    EXPECT_EQ(log, (std::vector<int>{2, 1}));
+    EXPECT_EQ(arena.getStats().pendingDestructorCount, 1u);
+  }
+  EXPECT_EQ(log, (std::vector<int>{2, 1, 0}));
+}
+
+TEST_F(ArenaAllocatorTest, MemoryResourceBacksPmrContainers) {
+  ml::ArenaAllocator arena;
+  std::pmr::memory_resource *resource = arena.getMemoryResource();
+
+  ml::ArenaPmrVector<int> numbers(resource);
+  ml::ArenaPmrString text("a string too long for small buffers", resource);
+  ml::ArenaPmrUnorderedMap<int, int> map(resource);
+  for (int i = 0; i < 100; ++i) {
+    numbers.push_back(i);
+    map[i] = i * i;
+  }
+
+  EXPECT_TRUE(arena.contains(numbers.data()));
+  EXPECT_TRUE(arena.contains(text.data()));
+  EXPECT_EQ(map.at(9), 81);
+
+  // Interchangeable with other pmr containers of the same element type
+  std::pmr::vector<int> copy(numbers.begin(), numbers.end(), resource);
+  copy.swap(numbers);
+  EXPECT_EQ(copy.size(), 100u);
+
+  ml::ArenaMemoryResource other(arena);
+  EXPECT_TRUE(resource->is_equal(other));
+}
+
+TEST_F(ArenaAllocatorTest, MemoryResourceForwardsOversizedRequests) {
+  ml::ArenaAllocator arena;
+  std::pmr::memory_resource *resource = arena.getMemoryResource();
+
+  size_t size = ml::ArenaAllocator::kMaxAllocationSize + 1;
+  void *ptr = resource->allocate(size);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_FALSE(arena.contains(ptr));
+  resource->deallocate(ptr, size);
+}
+
+TEST_F(ArenaAllocatorTest, ResizeTopAllocationInPlace) {
+  ml::ArenaAllocator arena;
+
+  void *first = arena.allocate(64);
+  ASSERT_TRUE(arena.resize(first, 64, 256));
+  size_t usage = arena.getStats().currentUsage;
+  ASSERT_TRUE(arena.resize(first, 256, 32));
+  EXPECT_EQ(arena.getStats().currentUsage, usage - 224);
+
+  // Once something follows it, the allocation is pinned
+  void *second = arena.allocate(16);
+  EXPECT_FALSE(arena.resize(first, 32, 64));
+  EXPECT_TRUE(arena.resize(second, 16, 64));
+
+  // Freeing the top allocation makes its memory reusable
+  arena.deallocate(second, 64);
+  EXPECT_EQ(arena.allocate(16), second);
+}
+
+TEST_F(ArenaAllocatorTest, ScopeToleratesFreeingOlderAllocations) {
+  ml::ArenaAllocator arena;
+
+  void *older = arena.allocate(256);
+  size_t usage = arena.getStats().currentUsage;
+  {
+    // A container from before the scope frees its buffer inside it
+    ml::ArenaScope scope(arena);
+    arena.deallocate(older, 256);
+    ASSERT_NE(arena.allocate(64), nullptr);
+  }
+
+  // The arena is not pushed back up to the marker
+  EXPECT_LT(arena.getStats().currentUsage, usage);
+  EXPECT_EQ(arena.getStats().chunkCount, 1u);
+  EXPECT_NE(arena.allocate(16), nullptr);
+}
+
+TEST_F(ArenaAllocatorTest, ResizeKeepsObjectsWithDestructors) {
+  ml::ArenaAllocator arena;
+  std::vector<int> log;
+
+  Tracked *object = arena.allocate<Tracked>(log, 1);
+  EXPECT_FALSE(arena.resize(object, sizeof(Tracked), 0));
+  arena.reset();
+  EXPECT_EQ(log, (std::vector<int>{1}));
+}
+
+TEST_F(ArenaAllocatorTest, NoStatsPolicyStillReportsUsage) {
+  ml::BasicArenaAllocator<ml::ArenaNoStats> arena;
+
+  void *ptr = arena.allocate(100);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_TRUE(arena.contains(ptr));
+
+  auto stats = arena.getStats();
+  EXPECT_EQ(stats.allocationCount, 0u);
+  EXPECT_EQ(stats.currentUsage, 100u);
+  EXPECT_EQ(stats.chunkCount, 1u);
+
+  std::ostringstream out;
+  arena.printStats(out);
+  EXPECT_NE(out.str().find("Allocation counters: disabled"),
+            std::string::npos);
+}
+
+TEST_F(ArenaAllocatorTest, TracingPolicyRecordsEvents) {
+  ml::BasicArenaAllocator<ml::ArenaTracingStats> arena;
+
+  {
+    ml::ArenaScope scope(arena);
+    arena.allocate(8);
+    arena.allocate(100);
+    arena.allocate(100);
+  }
+
+  const auto &trace = arena.getStatsPolicy();
+  EXPECT_EQ(trace.sizeHistogram[3], 1u);
+  EXPECT_EQ(trace.sizeHistogram[7], 2u);
+  ASSERT_EQ(trace.Events.size(), 4u);
+  EXPECT_EQ(trace.Events.back().kind, ml::ArenaTraceEvent::Kind::Release);
+  EXPECT_EQ(arena.getStats().allocationCount, 3u);
+
+  // A reset wipes the log and then records itself
+  arena.reset();
+  ASSERT_EQ(trace.Events.size(), 1u);
+  EXPECT_EQ(trace.Events.front().kind, ml::ArenaTraceEvent::Kind::Reset);
+
+  std::ostringstream out;
+  arena.printStats(out);
+  EXPECT_NE(out.str().find("Allocation size histogram"), std::string::npos);
+  EXPECT_NE(out.str().find("Resets: 1"), std::string::npos);
+}
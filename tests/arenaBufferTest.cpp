@@ -0,0 +1,76 @@
+#include "ml/Basic/ArenaBuffer.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class ArenaBufferTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(ArenaBufferTest, GrowsInPlace) {
+  ml::ArenaAllocator arena;
+  ml::ArenaBuffer<size_t> offsets(arena);
+
+  for (size_t i = 0; i < 10000; ++i) {
+    offsets.append(i * 3);
+  }
+  ASSERT_EQ(offsets.size(), 10000u);
+  EXPECT_EQ(offsets[9999], 29997u);
+
+  // Every growth extended the same block, so nothing was abandoned
+  EXPECT_EQ(arena.getStats().currentUsage,
+            offsets.capacity() * sizeof(size_t));
+
+  offsets.shrinkToFit();
+  EXPECT_EQ(offsets.capacity(), offsets.size());
+  EXPECT_EQ(arena.getStats().currentUsage, offsets.size() * sizeof(size_t));
+}
+
+TEST_F(ArenaBufferTest, CopiesWhenNotAtTop) {
+  ml::ArenaAllocator arena;
+  ml::ArenaBuffer<int> first(arena);
+  ml::ArenaBuffer<int> second(arena);
+
+  // Interleaved growth forces a copy, but the contents survive
+  for (int i = 0; i < 1000; ++i) {
+    first.append(i);
+    second.append(-i);
+  }
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(first[static_cast<size_t>(i)], i);
+    EXPECT_EQ(second[static_cast<size_t>(i)], -i);
+  }
+  EXPECT_TRUE(arena.contains(first.data()));
+  EXPECT_TRUE(arena.contains(second.data()));
+}
+
+TEST_F(ArenaBufferTest, AppendRangeAndResize) {
+  ml::ArenaAllocator arena;
+  ml::ArenaBuffer<char> text(arena);
+
+  text.append("hello", 5);
+  text.append(' ');
+  text.append("world", 5);
+  EXPECT_EQ(std::string(text.begin(), text.end()), "hello world");
+
+  text.resize(13);
+  EXPECT_EQ(text[12], '\0');
+  text.clear();
+  EXPECT_TRUE(text.empty());
+  EXPECT_GE(text.capacity(), 13u);
+}
+
+TEST_F(ArenaBufferTest, STLVectorReclaimsTopBuffer) {
+  ml::ArenaAllocator arena;
+  size_t usage = arena.getStats().currentUsage;
+
+  {
+    ml::ArenaVector<int> scratch{ml::ArenaSTLAllocator<int>(arena)};
+    scratch.reserve(256);
+  }
+
+  // The released buffer was the most recent allocation
+  EXPECT_EQ(arena.getStats().currentUsage, usage);
+}
@@ -0,0 +1,98 @@
+#include "ml/Basic/ArenaAllocator.hpp"
+#include "ml/Basic/ArenaProfiler.hpp"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+class ArenaProfilerTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+using ProfilingArena = ml::BasicArenaAllocator<ml::ArenaProfilingStats>;
+
+namespace {
+
+uint64_t tagOf(std::initializer_list<ml::ArenaCategory> categories) {
+  uint64_t tag = 0;
+  for (ml::ArenaCategory category : categories) {
+    tag = (tag << 4) | static_cast<uint64_t>(category);
+  }
+  return tag;
+}
+
+} // namespace
+
+TEST_F(ArenaProfilerTest, NestedScopesFormStacks) {
+  ProfilingArena arena;
+
+  arena.allocate(32);
+  {
+    ml::ArenaProfileScope lexer(ml::ArenaCategory::Lexer);
+    arena.allocate(64);
+    {
+      ml::ArenaProfileScope interner(ml::ArenaCategory::Interner);
+      arena.allocate(16);
+      arena.allocate(16);
+    }
+  }
+  EXPECT_EQ(ml::ArenaProfileScope::getCurrentTag(), 0u);
+
+  const auto &profile = arena.getStatsPolicy();
+  EXPECT_EQ(profile.getEntry(0).byteCount, 32u);
+  EXPECT_EQ(profile.getEntry(tagOf({ml::ArenaCategory::Lexer})).byteCount,
+            64u);
+
+  auto nested = profile.getEntry(
+      tagOf({ml::ArenaCategory::Lexer, ml::ArenaCategory::Interner}));
+  EXPECT_EQ(nested.byteCount, 32u);
+  EXPECT_EQ(nested.allocationCount, 2u);
+
+  std::ostringstream folded;
+  profile.writeFoldedStacks(folded);
+  EXPECT_NE(folded.str().find("untagged 32\n"), std::string::npos);
+  EXPECT_NE(folded.str().find("lexer 64\n"), std::string::npos);
+  EXPECT_NE(folded.str().find("lexer;interner 32\n"), std::string::npos);
+}
+
+TEST_F(ArenaProfilerTest, RewindReleasesNewestTags) {
+  ProfilingArena arena;
+  uint64_t files = tagOf({ml::ArenaCategory::FileCache});
+  uint64_t diags = tagOf({ml::ArenaCategory::Diagnostics});
+
+  {
+    ml::ArenaProfileScope scope(ml::ArenaCategory::FileCache);
+    arena.allocate(256);
+  }
+
+  {
+    ml::ArenaScope scope(arena);
+    ml::ArenaProfileScope tag(ml::ArenaCategory::Diagnostics);
+    arena.allocate(128);
+    arena.allocate(128);
+    EXPECT_EQ(arena.getStatsPolicy().getEntry(diags).liveByteCount, 256u);
+  }
+
+  const auto &profile = arena.getStatsPolicy();
+  EXPECT_EQ(profile.getEntry(diags).liveByteCount, 0u);
+  EXPECT_EQ(profile.getEntry(diags).peakByteCount, 256u);
+  EXPECT_EQ(profile.getEntry(files).liveByteCount, 256u);
+
+  arena.clear();
+  EXPECT_EQ(arena.getStatsPolicy().getEntry(files).liveByteCount, 0u);
+  EXPECT_EQ(arena.getStatsPolicy().getEntry(files).byteCount, 256u);
+}
+
+TEST_F(ArenaProfilerTest, PrintStatsIncludesProfile) {
+  ProfilingArena arena;
+  {
+    ml::ArenaProfileScope scope(ml::ArenaCategory::Interner);
+    arena.allocateString("identifier");
+  }
+
+  std::ostringstream out;
+  arena.printStats(out);
+  EXPECT_NE(out.str().find("Allocation profile"), std::string::npos);
+  EXPECT_NE(out.str().find("interner"), std::string::npos);
+}
@@ -0,0 +1,234 @@
+#include "ml/Basic/ArenaSnapshot.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class ArenaSnapshotTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path = ::testing::TempDir() + "ml-arena-snapshot-" +
+           ::testing::UnitTest::GetInstance()->current_test_info()->name();
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::string path;
+};
+
+namespace {
+
+struct ListNode {
+  ml::SnapshotString name;
+  uint32_t value = 0;
+  ml::OffsetPtr<const ListNode> next;
+};
+
+} // namespace
+
+TEST_F(ArenaSnapshotTest, OffsetPtrSurvivesCopies) {
+  char buffer[64] = "relocatable";
+  struct Holder {
+    ml::OffsetPtr<char> ptr;
+  };
+
+  auto *holder = reinterpret_cast<Holder *>(buffer + 32);
+  new (holder) Holder{buffer};
+  EXPECT_EQ(holder->ptr.get(), buffer);
+  EXPECT_EQ(holder->ptr.getOffset(), -32);
+
+  ml::OffsetPtr<char> copy = holder->ptr;
+  EXPECT_EQ(copy.get(), buffer);
+  EXPECT_FALSE(ml::OffsetPtr<char>());
+}
+
+TEST_F(ArenaSnapshotTest, RoundTripsLinkedObjects) {
+  {
+    ml::ArenaSnapshotWriter writer;
+    const ListNode *head = nullptr;
+    for (uint32_t i = 0; i < 100; ++i) {
+      auto *node = writer.create<ListNode>();
+      node->name = writer.createString("node" + std::to_string(i));
+      node->value = i;
+      node->next = head;
+      head = node;
+    }
+    writer.setRoot(head);
+    ASSERT_FALSE(writer.write(path));
+  }
+
+  auto [snapshot, error] = ml::ArenaSnapshot::open(path);
+  ASSERT_FALSE(error) << error.message();
+  ASSERT_TRUE(snapshot);
+
+  uint32_t expected = 99;
+  size_t count = 0;
+  for (const ListNode *node = snapshot->getRoot<ListNode>(); node;
+       node = node->next.get()) {
+    EXPECT_TRUE(snapshot->contains(node));
+    EXPECT_EQ(node->value, expected);
+    EXPECT_EQ(node->name.view(), "node" + std::to_string(expected));
+    --expected;
+    ++count;
+  }
+  EXPECT_EQ(count, 100u);
+}
+
+TEST_F(ArenaSnapshotTest, RejectsInvalidImages) {
+  auto [missing, missingError] = ml::ArenaSnapshot::open(path);
+  EXPECT_FALSE(missing);
+  EXPECT_TRUE(missingError);
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "this is not a snapshot image at all";
+  }
+  auto [garbage, garbageError] = ml::ArenaSnapshot::open(path);
+  EXPECT_FALSE(garbage);
+  EXPECT_EQ(garbageError, std::errc::invalid_argument);
+
+  // A truncated image fails the size check
+  {
+    ml::ArenaSnapshotWriter writer;
+    writer.setRoot(writer.create<ListNode>());
+    ASSERT_FALSE(writer.write(path));
+  }
+  std::ifstream in(path, std::ios::binary);
+  std::string image((std::istreambuf_iterator<char>(in)),
+                    std::istreambuf_iterator<char>());
+  in.close();
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out.write(image.data(), static_cast<std::streamsize>(image.size() - 1));
+  }
+  auto [truncated, truncatedError] = ml::ArenaSnapshot::open(path);
+  EXPECT_FALSE(truncated);
+  EXPECT_EQ(truncatedError, std::errc::invalid_argument);
+}
+
+TEST_F(ArenaSnapshotTest, InternerLoadsWithoutCopying) {
+  {
+    ml::StringInterner interner;
+    interner.intern("alpha");
+    interner.intern("beta");
+    interner.intern("gamma");
+
+    ml::ArenaSnapshotWriter writer;
+    writer.setRoot(interner.writeSnapshot(writer));
+    ASSERT_FALSE(writer.write(path));
+  }
+
+  auto [snapshot, error] = ml::ArenaSnapshot::open(path);
+  ASSERT_FALSE(error) << error.message();
+
+  ml::StringInterner interner;
+  ml::InternedString existing = interner.intern("beta");
+  interner.loadSnapshot(*snapshot->getRoot<ml::StringTableImage>());
+  EXPECT_EQ(interner.size(), 3u);
+
+  ml::InternedString gamma = interner.intern("gamma");
+  EXPECT_TRUE(snapshot->contains(gamma.getData()));
+  EXPECT_EQ(gamma.toStringView(), "gamma");
+  EXPECT_EQ(interner.intern("beta"), existing);
+  EXPECT_FALSE(snapshot->contains(existing.getData()));
+
+  // The symbol alpha was written with is taken by beta, so it is copied
+  ml::InternedString alpha = interner.intern("alpha");
+  EXPECT_FALSE(snapshot->contains(alpha.getData()));
+  EXPECT_EQ(interner.getString(alpha.getSymbol()), alpha);
+  EXPECT_EQ(interner.getString(gamma.getSymbol()), gamma);
+}
+
+TEST_F(ArenaSnapshotTest, InternerKeepsSymbolsAcrossLoads) {
+  std::vector<ml::Symbol> written;
+  {
+    ml::StringInterner interner;
+    for (int i = 0; i < 3000; ++i) {
+      written.push_back(interner.internSymbol("sym" + std::to_string(i)));
+    }
+
+    ml::ArenaSnapshotWriter writer;
+    writer.setRoot(interner.writeSnapshot(writer));
+    ASSERT_FALSE(writer.write(path));
+  }
+
+  auto [snapshot, error] = ml::ArenaSnapshot::open(path);
+  ASSERT_FALSE(error) << error.message();
+
+  ml::StringInterner interner;
+  interner.loadSnapshot(*snapshot->getRoot<ml::StringTableImage>());
+  for (int i = 0; i < 3000; ++i) {
+    ml::InternedString str = interner.lookup("sym" + std::to_string(i));
+    EXPECT_TRUE(snapshot->contains(str.getData()));
+    EXPECT_EQ(str.getSymbol(), written[static_cast<size_t>(i)]);
+    EXPECT_EQ(interner.getString(written[static_cast<size_t>(i)]), str);
+  }
+
+  // New strings are numbered after the loaded ones
+  EXPECT_EQ(interner.internSymbol("fresh").getID(), 3001u);
+}
+
+TEST_F(ArenaSnapshotTest, InternerCopiesStringsWithCorruptSymbols) {
+  {
+    ml::StringInterner interner;
+    interner.intern("alpha");
+    interner.intern("beta");
+    interner.intern("gamma");
+
+    ml::ArenaSnapshotWriter writer;
+    writer.setRoot(interner.writeSnapshot(writer));
+    ASSERT_FALSE(writer.write(path));
+  }
+
+  // Point gamma's recorded symbol near the top of the ID space
+  {
+    std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+    std::string image((std::istreambuf_iterator<char>(file)),
+                      std::istreambuf_iterator<char>());
+    size_t offset = image.find(std::string("gamma", 6));
+    ASSERT_NE(offset, std::string::npos);
+    uint32_t id = ml::Symbol::kInvalidID - 1;
+    file.seekp(static_cast<std::streamoff>(offset - sizeof(id)));
+    file.write(reinterpret_cast<const char *>(&id), sizeof(id));
+  }
+
+  auto [snapshot, error] = ml::ArenaSnapshot::open(path);
+  ASSERT_FALSE(error) << error.message();
+
+  ml::StringInterner interner;
+  interner.loadSnapshot(*snapshot->getRoot<ml::StringTableImage>());
+  EXPECT_EQ(interner.size(), 3u);
+  EXPECT_TRUE(snapshot->contains(interner.lookup("beta").getData()));
+
+  ml::InternedString gamma = interner.lookup("gamma");
+  EXPECT_FALSE(snapshot->contains(gamma.getData()));
+  EXPECT_EQ(gamma.getSymbol().getID(), 3u);
+  EXPECT_EQ(interner.internSymbol("fresh").getID(), 4u);
+}
+
+TEST_F(ArenaSnapshotTest, InternerWritesIdenticalImages) {
+  auto writeImage = [&](bool freeze) {
+    ml::StringInterner interner;
+    for (int i = 0; i < 2000; ++i) {
+      interner.intern("name" + std::to_string(i));
+      if (freeze && i == 500) {
+        interner.freeze();
+      }
+    }
+
+    ml::ArenaSnapshotWriter writer;
+    writer.setRoot(interner.writeSnapshot(writer));
+    EXPECT_FALSE(writer.write(path));
+
+    std::ifstream in(path, std::ios::binary);
+    return std::string((std::istreambuf_iterator<char>(in)),
+                       std::istreambuf_iterator<char>());
+  };
+
+  // Table layout does not leak into the image
+  std::string plain = writeImage(false);
+  EXPECT_FALSE(plain.empty());
+  EXPECT_EQ(writeImage(true), plain);
+}
@@ -0,0 +1,124 @@
+#include "ml/Basic/ConcurrentArena.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include <algorithm>
+#include <cstring>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ConcurrentArenaTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(ConcurrentArenaTest, ThreadsGetDisjointMemory) {
+  ml::ArenaAllocator parent;
+  ml::ConcurrentArena arena(parent);
+
+  constexpr int kThreadCount = 8;
+  constexpr int kAllocationCount = 10000;
+  std::vector<std::vector<unsigned char *>> results(kThreadCount);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < kAllocationCount; ++i) {
+        size_t size = static_cast<size_t>(1 + (i % 64));
+        auto *ptr = static_cast<unsigned char *>(arena.allocate(size, 8));
+        ASSERT_NE(ptr, nullptr);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) % 8, 0u);
+        std::memset(ptr, t, size);
+        results[static_cast<size_t>(t)].push_back(ptr);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every allocation still holds the writing thread's id
+  for (int t = 0; t < kThreadCount; ++t) {
+    for (unsigned char *ptr : results[static_cast<size_t>(t)]) {
+      EXPECT_EQ(*ptr, static_cast<unsigned char>(t));
+      EXPECT_TRUE(parent.contains(ptr));
+    }
+  }
+  EXPECT_GT(arena.getStats().chunkCount, 0u);
+}
+
+TEST_F(ConcurrentArenaTest, LargeAllocationsGoToParent) {
+  ml::ArenaAllocator parent;
+  ml::ConcurrentArena arena(parent);
+
+  void *ptr = arena.allocate(64 * 1024);
+  ASSERT_NE(ptr, nullptr);
+  EXPECT_TRUE(parent.contains(ptr));
+  EXPECT_EQ(arena.getStats().chunkCount, 0u);
+}
+
+TEST_F(ConcurrentArenaTest, SmallAlignmentsUseTheDefault) {
+  ml::ArenaAllocator parent;
+  ml::ConcurrentArena arena(parent);
+
+  std::vector<void *> blocks;
+  for (size_t alignment : {size_t{0}, size_t{1}, size_t{8}, size_t{64}}) {
+    for (int i = 0; i < 3; ++i) {
+      void *ptr = arena.allocate(8, alignment);
+      ASSERT_NE(ptr, nullptr);
+      EXPECT_EQ(reinterpret_cast<uintptr_t>(ptr) %
+                    std::max(alignment, ml::ArenaAllocator::kDefaultAlignment),
+                0u);
+      std::memset(ptr, 0xCD, 8);
+      blocks.push_back(ptr);
+    }
+  }
+
+  // No block overlaps another
+  std::sort(blocks.begin(), blocks.end());
+  for (size_t i = 1; i < blocks.size(); ++i) {
+    EXPECT_GE(static_cast<char *>(blocks[i]) -
+                  static_cast<char *>(blocks[i - 1]),
+              8);
+  }
+}
+
+TEST_F(ConcurrentArenaTest, STLAllocator) {
+  ml::ArenaAllocator parent;
+  ml::ConcurrentArena arena(parent);
+
+  ml::ConcurrentArenaVector<int> values{
+      ml::ConcurrentArenaSTLAllocator<int>(arena)};
+  for (int i = 0; i < 1000; ++i) {
+    values.push_back(i);
+  }
+  EXPECT_EQ(values[999], 999);
+  EXPECT_TRUE(parent.contains(values.data()));
+}
+
+TEST_F(ConcurrentArenaTest, InternerInternsConcurrently) {
+  ml::ArenaAllocator parent;
+  ml::ConcurrentArena arena(parent);
+  ml::StringInterner interner(arena);
+
+  std::vector<std::thread> threads;
+  std::vector<std::vector<ml::InternedString>> results(4);
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < 1000; ++i) {
+        results[t].push_back(interner.intern("name" + std::to_string(i)));
+        arena.allocate(32);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(interner.size(), 1000u);
+  for (size_t t = 1; t < 4; ++t) {
+    EXPECT_EQ(results[t], results[0]);
+  }
+  EXPECT_TRUE(parent.contains(results[0][0].getData()));
+}
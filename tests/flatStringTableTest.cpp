@@ -0,0 +1,89 @@
+#include "ml/Basic/FlatStringTable.hpp"
+#include <functional>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+class FlatStringTableTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+
+  static size_t hashOf(std::string_view str) {
+    return std::hash<std::string_view>{}(str);
+  }
+};
+
+TEST_F(FlatStringTableTest, FindsInsertedStrings) {
+  ml::FlatStringTable table;
+  EXPECT_EQ(table.find("missing", hashOf("missing")), nullptr);
+
+  std::vector<std::string> strings;
+  for (int i = 0; i < 5000; ++i) {
+    strings.push_back("name" + std::to_string(i));
+  }
+  for (const auto &str : strings) {
+    const auto &entry = table.insert(str, hashOf(str));
+    EXPECT_EQ(entry.data, str.data());
+  }
+
+  EXPECT_EQ(table.size(), strings.size());
+  EXPECT_GE(table.getCapacity() * 7, table.size() * 8);
+  for (const auto &str : strings) {
+    const auto *entry = table.find(str, hashOf(str));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->data, str.data());
+    EXPECT_EQ(entry->view(), str);
+  }
+  EXPECT_EQ(table.find("name5000", hashOf("name5000")), nullptr);
+}
+
+TEST_F(FlatStringTableTest, ResolvesCollidingHashes) {
+  ml::FlatStringTable table;
+
+  // One hash for every string: all probing, no help from the tags
+  std::vector<std::string> strings = {"a", "ab", "abc", "b", "ba", "abd"};
+  for (const auto &str : strings) {
+    table.insert(str, 42);
+  }
+  for (const auto &str : strings) {
+    const auto *entry = table.find(str, 42);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->view(), str);
+  }
+  EXPECT_EQ(table.find("abe", 42), nullptr);
+  EXPECT_EQ(table.find("a", 43), nullptr);
+}
+
+TEST_F(FlatStringTableTest, IteratesAndClears) {
+  ml::FlatStringTable table;
+  table.reserve(100);
+  size_t capacity = table.getCapacity();
+  EXPECT_GE(capacity * 7, 100u * 8);
+
+  std::vector<std::string> strings;
+  for (int i = 0; i < 100; ++i) {
+    strings.push_back(std::to_string(i));
+  }
+  for (const auto &str : strings) {
+    table.insert(str, hashOf(str));
+  }
+  EXPECT_EQ(table.getCapacity(), capacity);
+
+  std::set<std::string> seen;
+  for (const auto &entry : table) {
+    seen.insert(std::string(entry.view()));
+  }
+  EXPECT_EQ(seen.size(), 100u);
+
+  ml::FlatStringTable moved(std::move(table));
+  EXPECT_EQ(moved.size(), 100u);
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.begin(), table.end());
+
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  EXPECT_EQ(moved.getMemoryUsage(), 0u);
+  EXPECT_EQ(moved.find("1", hashOf("1")), nullptr);
+}
@@ -0,0 +1,59 @@
+#include "ml/Basic/InternCache.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class InternCacheTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(InternCacheTest, AnswersRepeatsWithoutTheInterner) {
+  ml::StringInterner interner;
+  ml::InternCache cache(interner);
+
+  ml::InternedString first = cache.intern("len");
+  EXPECT_EQ(cache.getMissCount(), 1u);
+  size_t lookups = interner.getStats().lookupCount;
+
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(cache.intern(std::string("len")), first);
+  }
+  EXPECT_EQ(cache.getHitCount(), 100u);
+  EXPECT_EQ(interner.getStats().lookupCount, lookups);
+  EXPECT_EQ(cache.intern(""), interner.intern(""));
+}
+
+TEST_F(InternCacheTest, AgreesWithTheInternerWhenSlotsClash) {
+  ml::StringInterner interner;
+  ml::InternCache cache(interner);
+
+  // Far more strings than slots, many sharing first, middle and last bytes
+  std::vector<std::string> names;
+  for (int i = 0; i < 5000; ++i) {
+    names.push_back("v" + std::to_string(i) + "x");
+  }
+  for (int round = 0; round < 2; ++round) {
+    for (const auto &name : names) {
+      ml::InternedString str = cache.intern(name);
+      EXPECT_EQ(str.toStringView(), name);
+      EXPECT_EQ(str, interner.lookup(name));
+    }
+  }
+  EXPECT_EQ(cache.getHitCount() + cache.getMissCount(), 10000u);
+  EXPECT_EQ(interner.size(), 5000u);
+}
+
+TEST_F(InternCacheTest, ForgetsHandlesOnClear) {
+  ml::StringInterner interner;
+  ml::InternCache cache(interner);
+  cache.intern("count");
+
+  interner.clear();
+  cache.clear();
+  EXPECT_FALSE(cache.lookup("count").isValid());
+  ml::InternedString fresh = cache.intern("count");
+  EXPECT_EQ(fresh, interner.lookup("count"));
+}
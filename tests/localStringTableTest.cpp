@@ -0,0 +1,123 @@
+#include "ml/Basic/LocalStringTable.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+class LocalStringTableTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(LocalStringTableTest, NumbersStringsByFirstOccurrence) {
+  ml::LocalStringTable table;
+  EXPECT_EQ(table.intern(""), 0u);
+  EXPECT_TRUE(table.empty());
+
+  std::vector<std::string> names;
+  for (int i = 0; i < 5000; ++i) {
+    names.push_back("name" + std::to_string(i));
+  }
+  for (int round = 0; round < 2; ++round) {
+    for (size_t i = 0; i < names.size(); ++i) {
+      EXPECT_EQ(table.intern(names[i]), i + 1);
+    }
+  }
+
+  EXPECT_EQ(table.size(), names.size());
+  EXPECT_EQ(table.getSymbolCount(), names.size() + 1);
+  EXPECT_EQ(table.getString(0), "");
+  for (size_t i = 0; i < names.size(); ++i) {
+    EXPECT_EQ(table.getString(static_cast<uint32_t>(i + 1)), names[i]);
+    EXPECT_EQ(table.getStrings()[i], names[i]);
+  }
+}
+
+TEST_F(LocalStringTableTest, RecordsViewsWithoutCopying) {
+  std::string source = "alpha beta alpha";
+  std::string_view text = source;
+
+  ml::LocalStringTable table;
+  EXPECT_EQ(table.intern(text.substr(0, 5)), 1u);
+  EXPECT_EQ(table.intern(text.substr(6, 4)), 2u);
+  EXPECT_EQ(table.intern(text.substr(11, 5)), 1u);
+  EXPECT_EQ(table.getString(1).data(), source.data());
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.intern("beta"), 1u);
+}
+
+// The merge BatchTokenizer::tokenizeParallel performs: number each file in
+// its own table, resolve what the interner already holds, intern the rest
+// in file order and remap. Symbols must match interning the files in turn.
+TEST_F(LocalStringTableTest, MergedSymbolsMatchSequentialInterning) {
+  constexpr size_t kFiles = 12;
+  std::vector<std::vector<std::string>> files(kFiles);
+  for (size_t f = 0; f < kFiles; ++f) {
+    for (size_t i = 0; i < 3000; ++i) {
+      files[f].push_back("w" + std::to_string((f * 131 + i * i) % 2500));
+    }
+  }
+
+  // Both interners already hold a few of the strings
+  ml::StringInterner sequential;
+  ml::StringInterner merged;
+  for (const char *known : {"w7", "w1000", "keyword"}) {
+    sequential.intern(known);
+    merged.intern(known);
+  }
+
+  std::vector<std::vector<ml::Symbol>> expected(kFiles);
+  for (size_t f = 0; f < kFiles; ++f) {
+    for (const auto &str : files[f]) {
+      expected[f].push_back(sequential.intern(str).getSymbol());
+    }
+  }
+
+  // Lex: local IDs only
+  std::vector<ml::LocalStringTable> tables(kFiles);
+  std::vector<std::vector<ml::Symbol>> actual(kFiles);
+  for (size_t f = 0; f < kFiles; ++f) {
+    for (const auto &str : files[f]) {
+      actual[f].push_back(ml::Symbol(tables[f].intern(str)));
+    }
+  }
+
+  // Resolve known strings, collecting the misses in local ID order
+  std::vector<std::vector<ml::Symbol>> remaps(kFiles);
+  std::vector<std::vector<std::string_view>> misses(kFiles);
+  std::vector<std::vector<uint32_t>> missIDs(kFiles);
+  for (size_t f = 0; f < kFiles; ++f) {
+    auto strs = tables[f].getStrings();
+    remaps[f].assign(tables[f].getSymbolCount(), ml::Symbol());
+    remaps[f][0] = ml::Symbol(0);
+    for (size_t k = 0; k < strs.size(); ++k) {
+      ml::InternedString str = merged.lookup(strs[k]);
+      if (str.isValid()) {
+        remaps[f][k + 1] = str.getSymbol();
+      } else {
+        misses[f].push_back(strs[k]);
+        missIDs[f].push_back(static_cast<uint32_t>(k + 1));
+      }
+    }
+  }
+
+  // Intern the misses in file order, then remap
+  for (size_t f = 0; f < kFiles; ++f) {
+    std::vector<ml::InternedString> out(misses[f].size());
+    merged.internBatch(misses[f], out);
+    for (size_t k = 0; k < out.size(); ++k) {
+      remaps[f][missIDs[f][k]] = out[k].getSymbol();
+    }
+  }
+  for (size_t f = 0; f < kFiles; ++f) {
+    for (ml::Symbol &symbol : actual[f]) {
+      symbol = remaps[f][symbol.getID()];
+    }
+  }
+
+  EXPECT_EQ(actual, expected);
+  EXPECT_EQ(merged.getSymbolCount(), sequential.getSymbolCount());
+}
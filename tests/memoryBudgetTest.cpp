@@ -0,0 +1,157 @@
+#include "ml/Basic/ArenaAllocator.hpp"
+#include "ml/Basic/MemoryBudget.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include "ml/Managers/FileManager.hpp"
+#include <cstdio>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+
+class MemoryBudgetTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(MemoryBudgetTest, TracksClientsSeparately) {
+  ml::MemoryBudget budget;
+  auto *first = budget.registerClient("first");
+  auto *second = budget.registerClient("second");
+
+  EXPECT_TRUE(budget.charge(first, 100));
+  EXPECT_TRUE(budget.charge(second, 50));
+  budget.release(first, 30);
+
+  EXPECT_EQ(first->getUsedBytes(), 70u);
+  EXPECT_EQ(second->getUsedBytes(), 50u);
+  EXPECT_EQ(budget.getUsedBytes(), 120u);
+  EXPECT_EQ(budget.getStats().peakBytes, 150u);
+
+  budget.unregisterClient(second);
+  EXPECT_EQ(budget.getUsedBytes(), 70u);
+
+  std::ostringstream out;
+  budget.printStats(out);
+  EXPECT_NE(out.str().find("first: 70 bytes"), std::string::npos);
+}
+
+TEST_F(MemoryBudgetTest, EvictsBeforeReportingOverflow) {
+  ml::MemoryBudget budget(1000);
+  ml::MemoryBudget::Client *cache = nullptr;
+  cache = budget.registerClient("cache", [&](size_t) {
+    size_t freed = cache->getUsedBytes();
+    budget.release(cache, freed);
+    return freed;
+  });
+  auto *pinned = budget.registerClient("pinned");
+
+  std::vector<std::string> overflows;
+  budget.setOverflowHandler(
+      [&](const ml::MemoryBudget::Client &client, size_t, size_t) {
+        overflows.push_back(client.getName());
+      });
+
+  // Evicting the cache makes room
+  EXPECT_TRUE(budget.charge(cache, 600));
+  EXPECT_TRUE(budget.charge(pinned, 600));
+  EXPECT_EQ(cache->getUsedBytes(), 0u);
+  EXPECT_EQ(budget.getStats().evictedBytes, 600u);
+  EXPECT_TRUE(overflows.empty());
+
+  // Nothing left to evict; reported once until usage drops again
+  EXPECT_FALSE(budget.charge(pinned, 600));
+  EXPECT_FALSE(budget.charge(pinned, 10));
+  EXPECT_EQ(overflows.size(), 1u);
+  EXPECT_EQ(overflows.front(), "pinned");
+
+  budget.release(pinned, 610);
+  EXPECT_FALSE(budget.charge(pinned, 1000));
+  EXPECT_EQ(overflows.size(), 2u);
+  EXPECT_EQ(budget.getStats().overflowCount, 3u);
+}
+
+TEST_F(MemoryBudgetTest, ReportsOverflowsBeforeTheHandlerWasSet) {
+  ml::MemoryBudget budget(100);
+  auto *client = budget.registerClient("early");
+
+  // Nobody hears of this overflow, so it must not latch the episode
+  EXPECT_FALSE(budget.charge(client, 200));
+
+  std::vector<std::string> overflows;
+  budget.setOverflowHandler(
+      [&](const ml::MemoryBudget::Client &overflowed, size_t, size_t) {
+        overflows.push_back(overflowed.getName());
+      });
+  EXPECT_FALSE(budget.charge(client, 10));
+  EXPECT_FALSE(budget.charge(client, 10));
+  ASSERT_EQ(overflows.size(), 1u);
+  EXPECT_EQ(overflows.front(), "early");
+  EXPECT_EQ(budget.getStats().overflowCount, 3u);
+}
+
+TEST_F(MemoryBudgetTest, ArenaChargesChunks) {
+  ml::MemoryBudget budget;
+  {
+    ml::ArenaAllocator arena(4096);
+    arena.setMemoryBudget(&budget);
+    EXPECT_EQ(budget.getUsedBytes(), arena.getTotalAllocated());
+
+    for (int i = 0; i < 10; ++i) {
+      arena.allocate(4000);
+    }
+    EXPECT_EQ(budget.getUsedBytes(), arena.getTotalAllocated());
+
+    arena.setMaxRetainedBytes(0);
+    arena.reset();
+    EXPECT_EQ(budget.getUsedBytes(), arena.getTotalAllocated());
+    EXPECT_EQ(arena.getStats().chunkCount, 1u);
+  }
+  EXPECT_EQ(budget.getUsedBytes(), 0u);
+}
+
+TEST_F(MemoryBudgetTest, InternerChargesNewStrings) {
+  ml::MemoryBudget budget;
+  ml::StringInterner interner;
+  interner.setMemoryBudget(&budget);
+
+  interner.intern("budgeted");
+  size_t used = budget.getUsedBytes();
+  EXPECT_GT(used, std::string_view("budgeted").size());
+
+  interner.intern("budgeted");
+  EXPECT_EQ(budget.getUsedBytes(), used);
+
+  interner.clear();
+  EXPECT_EQ(budget.getUsedBytes(), 0u);
+}
+
+TEST_F(MemoryBudgetTest, FileCacheEvictsUnderPressure) {
+  std::string first = ::testing::TempDir() + "ml-budget-first.txt";
+  std::string second = ::testing::TempDir() + "ml-budget-second.txt";
+  std::ofstream(first) << std::string(600, 'a');
+  std::ofstream(second) << std::string(600, 'b');
+
+  ml::MemoryBudget budget(1000);
+  ml::StringInterner interner;
+  ml::FileManager fileMgr(interner);
+  fileMgr.setMemoryBudget(&budget);
+
+  ASSERT_TRUE(fileMgr.getFile(first));
+  EXPECT_EQ(fileMgr.getStats().fileCacheCount, 1u);
+
+  // The first file is no longer in use, so it makes room for the second
+  auto entry = fileMgr.getFile(second);
+  ASSERT_TRUE(entry);
+  EXPECT_EQ(fileMgr.getStats().fileCacheCount, 1u);
+  EXPECT_LE(budget.getUsedBytes(), 1000u);
+  EXPECT_EQ(budget.getStats().overflowCount, 0u);
+
+  // A file in use is never evicted; the new one is served uncached
+  ASSERT_TRUE(fileMgr.getFile(first));
+  EXPECT_EQ(fileMgr.getStats().fileCacheCount, 1u);
+  EXPECT_EQ(budget.getStats().overflowCount, 1u);
+
+  std::remove(first.c_str());
+  std::remove(second.c_str());
+}
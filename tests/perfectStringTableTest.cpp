@@ -0,0 +1,72 @@
+#include "ml/Basic/PerfectStringTable.hpp"
+#include <functional>
+#include <gtest/gtest.h>
+#include <set>
+#include <string>
+#include <vector>
+
+class PerfectStringTableTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+
+  static uint64_t hashOf(std::string_view str) {
+    return std::hash<std::string_view>{}(str);
+  }
+};
+
+TEST_F(PerfectStringTableTest, FindsEveryKey) {
+  std::vector<std::string> strings;
+  for (int i = 0; i < 10000; ++i) {
+    strings.push_back("ident" + std::to_string(i));
+  }
+  std::vector<ml::PerfectStringTable::Key> keys;
+  for (const auto &str : strings) {
+    keys.push_back({str, hashOf(str)});
+  }
+
+  std::vector<ml::PerfectStringTable::Key> rejected;
+  auto table = ml::PerfectStringTable::build(keys, rejected);
+  EXPECT_TRUE(rejected.empty());
+  EXPECT_EQ(table->size(), strings.size());
+  EXPECT_LE(table->size() * 5, table->getCapacity() * 4);
+
+  for (const auto &str : strings) {
+    const auto *entry = table->find(str, hashOf(str));
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->data, str.data());
+  }
+  EXPECT_EQ(table->find("ident10000", hashOf("ident10000")), nullptr);
+  EXPECT_EQ(table->find("", hashOf("")), nullptr);
+
+  std::set<std::string_view> seen;
+  for (size_t slot = table->findOccupied(0); slot < table->getCapacity();
+       slot = table->findOccupied(slot + 1)) {
+    seen.insert(table->getEntry(slot).view());
+  }
+  EXPECT_EQ(seen.size(), strings.size());
+}
+
+TEST_F(PerfectStringTableTest, RejectsEqualHashes) {
+  std::vector<ml::PerfectStringTable::Key> keys = {
+      {"first", 7}, {"second", 7}, {"third", hashOf("third")}};
+
+  std::vector<ml::PerfectStringTable::Key> rejected;
+  auto table = ml::PerfectStringTable::build(keys, rejected);
+  ASSERT_EQ(rejected.size(), 1u);
+  EXPECT_EQ(table->size(), 2u);
+
+  // Exactly one of the colliding keys was placed
+  const auto *kept = table->find("first", 7);
+  EXPECT_NE(kept == nullptr, table->find("second", 7) == nullptr);
+  EXPECT_EQ(rejected.front().str, kept ? "second" : "first");
+  EXPECT_NE(table->find("third", hashOf("third")), nullptr);
+}
+
+TEST_F(PerfectStringTableTest, BuildsEmptyTable) {
+  std::vector<ml::PerfectStringTable::Key> rejected;
+  auto table = ml::PerfectStringTable::build({}, rejected);
+  EXPECT_TRUE(table->empty());
+  EXPECT_EQ(table->find("any", hashOf("any")), nullptr);
+  EXPECT_EQ(table->findOccupied(0), table->getCapacity());
+}
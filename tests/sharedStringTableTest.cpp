@@ -0,0 +1,186 @@
+#include "ml/Basic/SharedStringTable.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+class SharedStringTableTest : public ::testing::Test {
+protected:
+  void SetUp() override {
+    path = ::testing::TempDir() + "ml-shared-table-" +
+           ::testing::UnitTest::GetInstance()->current_test_info()->name();
+    std::remove(path.c_str());
+  }
+
+  void TearDown() override { std::remove(path.c_str()); }
+
+  std::string path;
+};
+
+TEST_F(SharedStringTableTest, SharesSymbolsBetweenMappings) {
+  auto [first, firstError] = ml::SharedStringTable::open(path, 1000, 1 << 16);
+  ASSERT_FALSE(firstError);
+  ASSERT_TRUE(first);
+  EXPECT_TRUE(first->empty());
+
+  ml::InternedString hello = first->intern("hello");
+  EXPECT_EQ(first->intern(std::string("hello")), hello);
+  EXPECT_EQ(hello.toStringView(), "hello");
+  EXPECT_EQ(hello.length(), 5u);
+  EXPECT_EQ(hello.getSymbol().getID(), 1u);
+  EXPECT_EQ(first->intern("").getSymbol().getID(), 0u);
+
+  // A second mapping of the file sees the same strings under the same IDs;
+  // its own capacity arguments are ignored
+  auto [second, secondError] = ml::SharedStringTable::open(path, 5, 64);
+  ASSERT_FALSE(secondError);
+  EXPECT_EQ(second->getMappingSize(), first->getMappingSize());
+  ml::InternedString seen = second->lookup("hello");
+  ASSERT_TRUE(seen.isValid());
+  EXPECT_EQ(seen.getSymbol(), hello.getSymbol());
+  EXPECT_NE(seen.getData(), hello.getData());
+
+  ml::InternedString world = second->intern("world");
+  EXPECT_EQ(first->getString(world.getSymbol()).toStringView(), "world");
+  EXPECT_TRUE(first->contains("world"));
+  EXPECT_FALSE(first->contains("missing"));
+  EXPECT_EQ(first->size(), 2u);
+  EXPECT_EQ(first->getSymbolCount(), 3u);
+  EXPECT_FALSE(first->getString(ml::Symbol(3)).isValid());
+}
+
+TEST_F(SharedStringTableTest, ConcurrentMappingsAgree) {
+  constexpr int kThreads = 4;
+  constexpr int kStrings = 2000;
+  // Each thread creates or maps the file itself, as a separate process
+  // would; one creation wins and the others map its file
+  std::vector<std::vector<ml::Symbol>> symbols(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      auto [table, error] = ml::SharedStringTable::open(path, 10000, 1 << 20);
+      ASSERT_FALSE(error);
+      for (int i = 0; i < kStrings; ++i) {
+        int n = (i * 7 + t * 13) % kStrings;
+        symbols[static_cast<size_t>(t)].push_back(
+            table->intern("s" + std::to_string(n)).getSymbol());
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  auto [table, error] = ml::SharedStringTable::open(path);
+  ASSERT_FALSE(error);
+  EXPECT_EQ(table->size(), static_cast<size_t>(kStrings));
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kStrings; ++i) {
+      int n = (i * 7 + t * 13) % kStrings;
+      ml::Symbol symbol =
+          symbols[static_cast<size_t>(t)][static_cast<size_t>(i)];
+      EXPECT_EQ(table->getString(symbol).toString(), "s" + std::to_string(n));
+    }
+  }
+}
+
+#ifndef _WIN32
+TEST_F(SharedStringTableTest, ProcessesShareOneSymbolSpace) {
+  auto [table, error] = ml::SharedStringTable::open(path, 1000, 1 << 16);
+  ASSERT_FALSE(error);
+  ml::Symbol parent = table->intern("parent").getSymbol();
+
+  pid_t child = fork();
+  ASSERT_GE(child, 0);
+  if (child == 0) {
+    auto [own, ownError] = ml::SharedStringTable::open(path);
+    bool ok = !ownError && own->lookup("parent").getSymbol() == parent;
+    ok = ok && own->intern("child").isValid();
+    _exit(ok ? 0 : 1);
+  }
+
+  int status = 0;
+  ASSERT_EQ(waitpid(child, &status, 0), child);
+  ASSERT_TRUE(WIFEXITED(status));
+  EXPECT_EQ(WEXITSTATUS(status), 0);
+  EXPECT_EQ(table->lookup("child").getSymbol().getID(), parent.getID() + 1);
+}
+#endif
+
+TEST_F(SharedStringTableTest, RejectsFullTablesAndForeignFiles) {
+  {
+    auto [table, error] = ml::SharedStringTable::open(path, 2, 1 << 16);
+    ASSERT_FALSE(error);
+    table->intern("a");
+    table->intern("b");
+    EXPECT_EQ(table->intern("a").getSymbol().getID(), 1u);
+    EXPECT_THROW(table->intern("c"), std::length_error);
+    EXPECT_FALSE(table->contains("c"));
+  }
+  std::remove(path.c_str());
+
+  {
+    auto [table, error] = ml::SharedStringTable::open(path, 100, 64);
+    ASSERT_FALSE(error);
+    EXPECT_THROW(table->intern(std::string(100, 'x')), std::bad_alloc);
+    EXPECT_LE(table->getHeapUsed(), 64u);
+  }
+  std::remove(path.c_str());
+
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << std::string(4096, 'x');
+  }
+  auto [garbage, garbageError] = ml::SharedStringTable::open(path);
+  EXPECT_EQ(garbageError, std::errc::invalid_argument);
+  EXPECT_FALSE(garbage);
+
+  auto [bad, badError] =
+      ml::SharedStringTable::open(path + ".missing", 0, 1 << 16);
+  EXPECT_EQ(badError, std::errc::invalid_argument);
+  EXPECT_FALSE(bad);
+}
+
+TEST_F(SharedStringTableTest, RejectsCorruptHeapBounds) {
+  {
+    auto [table, error] = ml::SharedStringTable::open(path, 100, 1 << 16);
+    ASSERT_FALSE(error);
+    table->intern("kept");
+  }
+
+  std::string image;
+  {
+    std::ifstream in(path, std::ios::binary);
+    image.assign((std::istreambuf_iterator<char>(in)),
+                 std::istreambuf_iterator<char>());
+  }
+
+  // Header words are patched by byte offset: the heap starts at 48 and its
+  // top is at 56
+  uint64_t heapOffset = 0;
+  std::memcpy(&heapOffset, image.data() + 48, sizeof(heapOffset));
+  auto openPatched = [&](size_t offset, uint64_t value) {
+    std::string corrupt = image;
+    std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << corrupt;
+    return ml::SharedStringTable::open(path).second;
+  };
+
+  // A heap reaching into the slot index would be written over it
+  EXPECT_EQ(openPatched(48, heapOffset - 8), std::errc::invalid_argument);
+  EXPECT_EQ(openPatched(56, heapOffset - 8), std::errc::invalid_argument);
+
+  std::ofstream(path, std::ios::binary | std::ios::trunc) << image;
+  auto [table, error] = ml::SharedStringTable::open(path);
+  ASSERT_FALSE(error);
+  EXPECT_TRUE(table->contains("kept"));
+}
@@ -0,0 +1,165 @@
+#include "ml/Basic/SlabAllocator.hpp"
+#include <cstring>
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+class SlabAllocatorTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(SlabAllocatorTest, ReusesFreedBlocks) {
+  ml::SlabAllocator slab;
+
+  void *first = slab.allocate(24);
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(first) % 16, 0u);
+  slab.deallocate(first, 24);
+
+  // The freed block is on top of this thread's magazine
+  void *second = slab.allocate(32);
+  EXPECT_EQ(first, second);
+  slab.deallocate(second, 32);
+}
+
+TEST_F(SlabAllocatorTest, CustomSizeClasses) {
+  ml::SlabAllocator slab({40, 24, 100, 24});
+
+  ASSERT_EQ(slab.getSizeClassCount(), 3u);
+  EXPECT_EQ(slab.getSizeClass(0), 32u);
+  EXPECT_EQ(slab.getSizeClass(1), 48u);
+  EXPECT_EQ(slab.getSizeClass(2), 112u);
+
+  void *ptr = slab.allocate(100);
+  ASSERT_NE(ptr, nullptr);
+  std::memset(ptr, 0xAB, 100);
+  EXPECT_EQ(slab.getStats().slabCount, 1u);
+  slab.deallocate(ptr, 100);
+
+  // Class indices must fit in a byte
+  std::vector<size_t> sizes;
+  for (size_t size = 16; size <= 255 * 16; size += 16) {
+    sizes.push_back(size);
+  }
+  EXPECT_THROW(ml::SlabAllocator tooMany(sizes), std::invalid_argument);
+  sizes.pop_back();
+  ml::SlabAllocator most(sizes);
+  EXPECT_EQ(most.getSizeClassCount(), 254u);
+  EXPECT_NE(most.allocate(254 * 16), nullptr);
+}
+
+TEST_F(SlabAllocatorTest, CountsBlocksPerCall) {
+  ml::SlabAllocator slab;
+
+  // The refill caches a magazine of 128-byte blocks; only one is in use
+  void *ptr = slab.allocate(100);
+  ASSERT_NE(ptr, nullptr);
+  auto stats = slab.getStats();
+  EXPECT_EQ(stats.allocationCount, 1u);
+  EXPECT_EQ(stats.currentUsage, 128u);
+  EXPECT_EQ(stats.peakUsage, 128u);
+  EXPECT_LT(stats.getUtilization(), 0.01);
+
+  slab.deallocate(ptr, 100);
+  stats = slab.getStats();
+  EXPECT_EQ(stats.deallocationCount, 1u);
+  EXPECT_EQ(stats.currentUsage, 0u);
+}
+
+TEST_F(SlabAllocatorTest, LargeAndOverAlignedRequestsUseHeap) {
+  ml::SlabAllocator slab;
+
+  void *large = slab.allocate(ml::SlabAllocator::kMaxDefaultBlockSize + 1);
+  void *aligned = slab.allocate(64, 64);
+  ASSERT_NE(large, nullptr);
+  ASSERT_NE(aligned, nullptr);
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+
+  auto stats = slab.getStats();
+  EXPECT_EQ(stats.largeAllocationCount, 2u);
+  EXPECT_EQ(stats.slabCount, 0u);
+
+  slab.deallocate(large, ml::SlabAllocator::kMaxDefaultBlockSize + 1);
+  slab.deallocate(aligned, 64, 64);
+}
+
+TEST_F(SlabAllocatorTest, FlushReturnsCachedBlocks) {
+  ml::SlabAllocator slab;
+
+  std::vector<void *> blocks;
+  for (int i = 0; i < 100; ++i) {
+    blocks.push_back(slab.allocate(64));
+  }
+  for (void *block : blocks) {
+    slab.deallocate(block, 64);
+  }
+  slab.flushThreadCache();
+
+  auto stats = slab.getStats();
+  EXPECT_EQ(stats.currentUsage, 0u);
+  EXPECT_EQ(stats.allocationCount, stats.deallocationCount);
+  EXPECT_GE(stats.peakUsage, 100u * 64u);
+}
+
+TEST_F(SlabAllocatorTest, ThreadsGetDisjointBlocks) {
+  ml::SlabAllocator slab;
+
+  constexpr int kThreadCount = 8;
+  constexpr int kAllocationCount = 5000;
+  std::vector<std::vector<unsigned char *>> results(kThreadCount);
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < kThreadCount; ++t) {
+    threads.emplace_back([&, t] {
+      auto &owned = results[static_cast<size_t>(t)];
+      for (int i = 0; i < kAllocationCount; ++i) {
+        auto *ptr = static_cast<unsigned char *>(slab.allocate(48));
+        ASSERT_NE(ptr, nullptr);
+        std::memset(ptr, t, 48);
+        owned.push_back(ptr);
+
+        // Free every other block to exercise magazine flushing
+        if (i % 2 == 1) {
+          slab.deallocate(owned[owned.size() - 2], 48);
+          owned.erase(owned.end() - 2);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  std::set<unsigned char *> seen;
+  for (int t = 0; t < kThreadCount; ++t) {
+    for (unsigned char *ptr : results[static_cast<size_t>(t)]) {
+      EXPECT_EQ(*ptr, static_cast<unsigned char>(t));
+      EXPECT_TRUE(seen.insert(ptr).second);
+    }
+  }
+
+  // Exited threads returned their magazines; 48 bytes rounds up to 64
+  auto stats = slab.getStats();
+  EXPECT_EQ(stats.currentUsage, seen.size() * 64u);
+}
+
+TEST_F(SlabAllocatorTest, STLAllocator) {
+  ml::SlabAllocator slab;
+
+  ml::SlabList<int> list{ml::SlabSTLAllocator<int>(slab)};
+  for (int i = 0; i < 1000; ++i) {
+    list.push_back(i);
+  }
+  list.clear();
+  size_t slabCount = slab.getStats().slabCount;
+
+  // Released nodes are reused rather than carved from new slabs
+  for (int i = 0; i < 1000; ++i) {
+    list.push_back(i);
+  }
+  EXPECT_EQ(slab.getStats().slabCount, slabCount);
+}
@@ -0,0 +1,43 @@
+#include "ml/Basic/StringHash.hpp"
+#include <gtest/gtest.h>
+#include <string>
+#include <unordered_set>
+
+class StringHashTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(StringHashTest, IsStableAcrossBuilds) {
+  // Snapshots store these hashes; changing them needs a new image version
+  EXPECT_EQ(ml::StringHash::hash(""), 0x545f23ddcfe838c4ull);
+  EXPECT_EQ(ml::StringHash::hash("identifier"), 0xed33ba410010c560ull);
+  EXPECT_EQ(ml::StringHash::hash(std::string(100, 'x')),
+            0xa4a92abc964597c5ull);
+}
+
+TEST_F(StringHashTest, SeparatesEveryLengthAndSeed) {
+  // Each length takes a different path: short, mid-sized, looped
+  std::string text(200, 'a');
+  std::unordered_set<uint64_t> seen;
+  for (size_t len = 0; len <= text.size(); ++len) {
+    std::string_view str(text.data(), len);
+    EXPECT_TRUE(seen.insert(ml::StringHash::hash(str)).second) << len;
+    EXPECT_TRUE(seen.insert(ml::StringHash::hash(str, 1)).second) << len;
+  }
+
+  // A change in any byte changes the hash
+  for (size_t i = 0; i < 100; ++i) {
+    std::string changed = text.substr(0, 100);
+    changed[i] = 'b';
+    EXPECT_TRUE(seen.insert(ml::StringHash::hash(changed)).second) << i;
+  }
+}
+
+TEST_F(StringHashTest, ProbesContainersWithViews) {
+  std::unordered_set<std::string, ml::StringHash, std::equal_to<>> names = {
+      "alpha", "beta"};
+  EXPECT_TRUE(names.contains(std::string_view("alpha")));
+  EXPECT_FALSE(names.contains(std::string_view("gamma")));
+}
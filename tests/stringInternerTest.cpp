@@ -0,0 +1,329 @@
+#include "ml/Basic/ArenaAllocator.hpp"
+#include "ml/Basic/MemoryBudget.hpp"
+#include "ml/Basic/StringInterner.hpp"
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+class StringInternerTest : public ::testing::Test {
+protected:
+  void SetUp() override {}
+  void TearDown() override {}
+};
+
+TEST_F(StringInternerTest, DeduplicatesStrings) {
+  ml::StringInterner interner;
+  ml::InternedString first = interner.intern("identifier");
+  ml::InternedString second = interner.intern(std::string("identifier"));
+
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(first.getData(), second.getData());
+  EXPECT_NE(interner.intern("other"), first);
+  EXPECT_EQ(interner.size(), 2u);
+  EXPECT_TRUE(interner.contains("other"));
+  EXPECT_FALSE(interner.lookup("missing").isValid());
+}
+
+TEST_F(StringInternerTest, StoresLengthAndHashInHeader) {
+  ml::StringInterner interner;
+  std::string text("embedded\0nul", 12);
+  ml::InternedString str = interner.intern(text);
+
+  const auto *header = ml::InternedStringHeader::fromData(str.getData());
+  EXPECT_EQ(header->getData(), str.getData());
+  EXPECT_EQ(str.length(), 12u);
+  EXPECT_EQ(str.toStringView(), text);
+  EXPECT_EQ(str.getHashValue(),
+            static_cast<size_t>(ml::InternedStringHeader::computeHash(text)));
+
+  ml::InternedString empty = interner.intern("");
+  EXPECT_EQ(empty.length(), 0u);
+  EXPECT_EQ(empty.getHashValue(),
+            static_cast<size_t>(ml::InternedStringHeader::computeHash("")));
+  EXPECT_EQ(ml::InternedString().getHashValue(), 0u);
+}
+
+TEST_F(StringInternerTest, AssignsDenseSymbols) {
+  ml::StringInterner interner;
+  EXPECT_EQ(interner.internSymbol("").getID(), 0u);
+  EXPECT_EQ(interner.getString(ml::Symbol(0)).toStringView(), "");
+
+  std::vector<ml::Symbol> symbols;
+  for (int i = 0; i < 5000; ++i) {
+    symbols.push_back(interner.internSymbol("sym" + std::to_string(i)));
+    EXPECT_EQ(symbols.back().getID(), static_cast<uint32_t>(i + 1));
+  }
+  EXPECT_EQ(interner.getSymbolCount(), 5001u);
+  EXPECT_EQ(interner.internSymbol("sym42"), symbols[42]);
+
+  for (size_t i = 0; i < symbols.size(); ++i) {
+    ml::InternedString str = interner.getString(symbols[i]);
+    EXPECT_EQ(str.toStringView(), "sym" + std::to_string(i));
+    EXPECT_EQ(str.getSymbol(), symbols[i]);
+  }
+  EXPECT_FALSE(interner.getString(ml::Symbol(5001)).isValid());
+  EXPECT_FALSE(interner.getString(ml::Symbol()).isValid());
+  EXPECT_FALSE(ml::InternedString().getSymbol().isValid());
+
+  interner.clear();
+  EXPECT_EQ(interner.internSymbol("sym0").getID(), 1u);
+}
+
+TEST_F(StringInternerTest, BatchMatchesSingleInterning) {
+  ml::StringInterner interner;
+  ml::InternedString known = interner.intern("known");
+  interner.freeze();
+  ml::InternedString overlay = interner.intern("overlay");
+
+  // More than one block, with repeats inside and across blocks
+  std::vector<std::string> storage;
+  for (int i = 0; i < 150; ++i) {
+    storage.push_back("name" + std::to_string(i % 100));
+  }
+  storage.push_back("known");
+  storage.push_back("overlay");
+  storage.push_back("");
+  std::vector<std::string_view> strs(storage.begin(), storage.end());
+  std::vector<ml::InternedString> out(strs.size());
+
+  size_t interned = interner.getStats().internCount;
+  interner.internBatch(strs, out);
+  EXPECT_EQ(interner.size(), 102u);
+  EXPECT_EQ(interner.getStats().internCount, interned + 100);
+  for (size_t i = 0; i < strs.size(); ++i) {
+    EXPECT_EQ(out[i], interner.intern(strs[i]));
+    EXPECT_EQ(out[i].toStringView(), strs[i]);
+  }
+  EXPECT_EQ(out[0], out[100]);
+  EXPECT_EQ(out[150], known);
+  EXPECT_EQ(out[151], overlay);
+  EXPECT_TRUE(out[152].isEmpty());
+
+  std::vector<ml::InternedString> small(1);
+  EXPECT_THROW(interner.internBatch(strs, small), std::length_error);
+}
+
+TEST_F(StringInternerTest, BatchNumbersLikeSingleInterning) {
+  std::vector<std::string> storage;
+  for (int i = 0; i < 2000; ++i) {
+    storage.push_back("t" + std::to_string((i * 37) % 1300));
+  }
+  std::vector<std::string_view> strs(storage.begin(), storage.end());
+
+  ml::StringInterner serial;
+  ml::StringInterner batched;
+  serial.intern("t5");
+  batched.intern("t5");
+
+  std::vector<ml::InternedString> out(strs.size());
+  batched.internBatch(strs, out);
+  for (size_t i = 0; i < strs.size(); ++i) {
+    EXPECT_EQ(out[i].getSymbol(), serial.internSymbol(strs[i])) << i;
+  }
+}
+
+TEST_F(StringInternerTest, IteratesInInsertionOrder) {
+  ml::StringInterner interner;
+  std::vector<std::string> expected;
+  for (int i = 0; i < 3000; ++i) {
+    expected.push_back("id" + std::to_string((i * 7919) % 3000));
+    interner.intern(expected.back());
+    interner.intern(expected.front()); // Repeats keep their first position
+    if (i == 1000) {
+      interner.freeze();
+    }
+  }
+  interner.intern("");
+
+  std::vector<std::string> seen;
+  for (ml::InternedString str : interner) {
+    seen.push_back(str.toString());
+  }
+  EXPECT_EQ(seen, expected);
+}
+
+TEST_F(StringInternerTest, AggregatesShardStatistics) {
+  ml::StringInterner interner;
+  for (int i = 0; i < 1000; ++i) {
+    interner.intern("name" + std::to_string(i % 100));
+  }
+
+  auto stats = interner.getStats();
+  EXPECT_EQ(stats.lookupCount, 1000u);
+  EXPECT_EQ(stats.internCount, 100u);
+  EXPECT_EQ(stats.uniqueStringCount, 100u);
+  EXPECT_GT(stats.averageLength, 4.0);
+  EXPECT_LT(stats.averageLength, 7.0);
+
+  // Iteration visits every string once, across all shards
+  std::set<std::string> seen;
+  for (ml::InternedString str : interner) {
+    seen.insert(std::string(str.toStringView()));
+  }
+  EXPECT_EQ(seen.size(), 100u);
+
+  interner.clear();
+  EXPECT_TRUE(interner.empty());
+  EXPECT_EQ(interner.getStats().lookupCount, 0u);
+}
+
+TEST_F(StringInternerTest, ConcurrentInterningAgrees) {
+  ml::ArenaAllocator arena;
+  ml::StringInterner interner(arena);
+
+  constexpr int kThreads = 8;
+  constexpr int kStrings = 2000;
+  std::vector<std::vector<ml::InternedString>> results(kThreads);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&, t] {
+      // Each thread walks the names in a different order
+      for (int i = 0; i < kStrings; ++i) {
+        int n = (i * 7 + t * 311) % kStrings;
+        results[static_cast<size_t>(t)].push_back(
+            interner.intern("sym" + std::to_string(n)));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(interner.size(), static_cast<size_t>(kStrings));
+  EXPECT_EQ(interner.getSymbolCount(), static_cast<size_t>(kStrings) + 1);
+  for (int t = 0; t < kThreads; ++t) {
+    for (int i = 0; i < kStrings; ++i) {
+      int n = (i * 7 + t * 311) % kStrings;
+      ml::InternedString str =
+          results[static_cast<size_t>(t)][static_cast<size_t>(i)];
+      EXPECT_EQ(str, interner.lookup("sym" + std::to_string(n)));
+      EXPECT_EQ(interner.getString(str.getSymbol()), str);
+    }
+  }
+  EXPECT_EQ(interner.getStats().lookupCount,
+            static_cast<size_t>(kThreads * kStrings));
+}
+
+TEST_F(StringInternerTest, MovedFromInternerStaysUsable) {
+  ml::StringInterner source;
+  ml::InternedString kept = source.intern("kept");
+
+  ml::StringInterner target(std::move(source));
+  EXPECT_EQ(target.lookup("kept"), kept);
+  EXPECT_TRUE(source.empty());
+  EXPECT_TRUE(source.intern("fresh").isValid());
+
+  target = std::move(source);
+  EXPECT_FALSE(target.contains("kept"));
+  EXPECT_TRUE(target.contains("fresh"));
+}
+
+TEST_F(StringInternerTest, FrozenStringsKeepHandles) {
+  ml::StringInterner interner;
+  std::vector<ml::InternedString> before;
+  for (int i = 0; i < 1000; ++i) {
+    before.push_back(interner.intern("kw" + std::to_string(i)));
+  }
+
+  interner.freeze();
+  EXPECT_TRUE(interner.isFrozen());
+  EXPECT_EQ(interner.size(), 1000u);
+
+  // Frozen hits do not reach the shards
+  size_t lookups = interner.getStats().lookupCount;
+  for (int i = 0; i < 1000; ++i) {
+    EXPECT_EQ(interner.intern("kw" + std::to_string(i)),
+              before[static_cast<size_t>(i)]);
+    EXPECT_TRUE(interner.contains("kw" + std::to_string(i)));
+  }
+  EXPECT_EQ(interner.getStats().lookupCount, lookups);
+
+  // New strings go to the overlay, and a second freeze folds them in
+  ml::InternedString late = interner.intern("late");
+  EXPECT_EQ(interner.size(), 1001u);
+  EXPECT_EQ(interner.getString(late.getSymbol()), late);
+  interner.freeze();
+  EXPECT_EQ(interner.intern("late"), late);
+  EXPECT_EQ(interner.lookup("kw7"), before[7]);
+
+  std::set<std::string> seen;
+  for (ml::InternedString str : interner) {
+    seen.insert(str.toString());
+  }
+  EXPECT_EQ(seen.size(), 1001u);
+
+  interner.clear();
+  EXPECT_FALSE(interner.isFrozen());
+  EXPECT_FALSE(interner.contains("kw1"));
+}
+
+TEST_F(StringInternerTest, LayersReclaimTransientStrings) {
+  ml::StringInterner base;
+  ml::InternedString keyword = base.intern("return");
+  base.freeze();
+
+  ml::StringInterner session;
+  session.setBaseLayer(&base);
+  EXPECT_EQ(session.getBaseLayer(), &base);
+
+  // Base strings keep the base's handles; new ones are numbered after it
+  EXPECT_EQ(session.intern("return"), keyword);
+  ml::InternedString local = session.intern("requestId");
+  EXPECT_GE(local.getSymbol().getID(), base.getSymbolCount());
+  EXPECT_EQ(session.getString(keyword.getSymbol()), keyword);
+  EXPECT_EQ(session.getString(local.getSymbol()), local);
+  EXPECT_TRUE(session.contains("return"));
+  EXPECT_FALSE(base.contains("requestId"));
+  EXPECT_EQ(session.size(), 1u);
+
+  std::vector<std::string_view> strs = {"return", "requestId", "other"};
+  std::vector<ml::InternedString> out(strs.size());
+  session.internBatch(strs, out);
+  EXPECT_EQ(out[0], keyword);
+  EXPECT_EQ(out[1], local);
+
+  std::vector<std::string> seen;
+  for (ml::InternedString str : session) {
+    seen.push_back(str.toString());
+  }
+  EXPECT_EQ(seen, (std::vector<std::string>{"requestId", "other"}));
+
+  // Clearing releases the layer only; numbering restarts after the base
+  size_t usedBytes = session.getMemoryUsage();
+  session.clear();
+  EXPECT_LT(session.getMemoryUsage(), usedBytes);
+  EXPECT_EQ(session.size(), 0u);
+  EXPECT_FALSE(session.contains("requestId"));
+  EXPECT_EQ(session.intern("return"), keyword);
+  EXPECT_EQ(session.intern("next").getSymbol().getID(),
+            base.getSymbolCount());
+  EXPECT_EQ(base.size(), 1u);
+}
+
+TEST_F(StringInternerTest, LayersGiveTheirMemoryBack) {
+  ml::StringInterner base;
+  base.intern("return");
+  base.freeze();
+
+  ml::MemoryBudget budget;
+  ml::StringInterner session;
+  session.setBaseLayer(&base);
+  session.setMemoryBudget(&budget);
+  for (int i = 0; i < 1000; ++i) {
+    session.intern("transient" + std::to_string(i));
+  }
+  EXPECT_GT(budget.getUsedBytes(), 1000u);
+
+  session.clear();
+  EXPECT_EQ(budget.getUsedBytes(), 0u);
+  session.setMemoryBudget(nullptr);
+
+  // A caller's arena keeps every byte it hands out, so it cannot back a
+  // layer
+  ml::ArenaAllocator arena;
+  ml::StringInterner arenaSession(arena);
+  EXPECT_THROW(arenaSession.setBaseLayer(&base), std::invalid_argument);
+}